@@ -0,0 +1,272 @@
+#define _GNU_SOURCE
+#include "project.h"
+#include "utils.h"
+#include "affinity.h"
+#include "tasks.h"
+#include "partitions.h"
+#include "aggregate.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    agg_group_t *table;      // Per-worker table, sized for the largest partition. Slots with count 0 are empty.
+} agg_worker_t;
+
+typedef struct {
+    const partition_set_t *set;
+    agg_worker_t *workers;
+    agg_output_t *output;
+    long long *group_counts;  // Per partition.
+    uint64_t *checksums;      // Per partition.
+} agg_ctx_t;
+
+// Global table slot. state: 0 empty, 1 key being published, 2 ready.
+typedef struct {
+    uint64_t key;
+    uint64_t count;
+    uint64_t sum;
+    int state;
+} global_slot_t;
+
+typedef struct {
+    int thread_id;
+    tuple_t *tuples;
+    int tuples_index;
+    int tuples_length;
+    global_slot_t *table;
+    uint32_t mask;
+} global_args_t;
+
+static uint32_t table_size_for(int count) {
+    uint32_t size = 2;
+    while (size < 2u * (uint32_t)count)
+        size <<= 1;
+    return size;
+}
+
+static void aggregate_partition(int partition, int worker_id, void *void_ctx) {
+    agg_ctx_t *ctx = (agg_ctx_t *)void_ctx;
+    const partition_set_t *set = ctx->set;
+    agg_group_t *table = ctx->workers[worker_id].table;
+
+    // At most a 50% load factor, so linear probing stays short.
+    uint32_t table_size = table_size_for(partition_set_total(set, partition));
+    uint32_t mask = table_size - 1;
+    memset(table, 0, table_size * sizeof(agg_group_t));
+
+    for (int f = 0; f < set->fragment_count; f++) {
+        int slot = f * set->partition_count + partition;
+        const tuple_t *fragment = set->buffers[slot];
+        for (int j = 0; j < set->sizes[slot]; j++) {
+            uint64_t key = load_u64(fragment[j].key);
+            uint32_t b = hash_bucket(hash_key(fragment[j].key), set->hash_bits, mask);
+            while (table[b].count != 0 && table[b].key != key)
+                b = (b + 1) & mask;
+            table[b].key = key;
+            table[b].count++;
+            table[b].sum += load_u64(fragment[j].value);
+        }
+    }
+
+    // Emit the groups; no other partition can contain these keys.
+    long long groups = 0;
+    uint64_t checksum = 0;
+    agg_group_t *out = ctx->output ? ctx->output->groups + ctx->output->offsets[partition] : NULL;
+    for (uint32_t b = 0; b < table_size; b++) {
+        if (table[b].count == 0)
+            continue;
+        if (out)
+            out[groups] = table[b];
+        checksum += table[b].sum;
+        groups++;
+    }
+    if (ctx->output)
+        ctx->output->counts[partition] = (int)groups;
+    ctx->group_counts[partition] = groups;
+    ctx->checksums[partition] = checksum;
+}
+
+int run_partitioned_aggregate_timed(tuple_t *tuples, int tuple_count, int thread_count, int hash_bits,
+                                    strategy_t strategy, agg_output_t *output, agg_result_t *result) {
+    if (!tuples || !result)
+        return -1;
+
+    partition_set_t set;
+    if (partition_set_init(&set, strategy, tuple_count, thread_count, hash_bits) != 0)
+        return -1;
+
+    int ret = -1;
+    int partition_count = set.partition_count;
+    agg_worker_t *workers = calloc(thread_count, sizeof(agg_worker_t));
+    long long *group_counts = malloc(partition_count * sizeof(long long));
+    uint64_t *checksums = malloc(partition_count * sizeof(uint64_t));
+    if (output)
+        memset(output, 0, sizeof(*output));
+    if (!workers || !group_counts || !checksums)
+        goto out;
+
+    struct timespec start, partitioned, end;
+    double throughput;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    if (run_strategy_timed(&set, tuples, tuple_count, thread_count, &throughput, NULL) != 0)
+        goto out;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &partitioned);
+
+    // Partition counts size both the tables and the output ranges.
+    int max_count = 0;
+    if (output) {
+        output->partition_count = partition_count;
+        output->offsets = malloc((partition_count + 1) * sizeof(int));
+        output->counts = calloc(partition_count, sizeof(int));
+        if (!output->offsets || !output->counts)
+            goto out;
+        output->offsets[0] = 0;
+    }
+    for (int p = 0; p < partition_count; p++) {
+        int total = partition_set_total(&set, p);
+        if (total > max_count)
+            max_count = total;
+        if (output)
+            output->offsets[p + 1] = output->offsets[p] + total;
+    }
+    if (output) {
+        output->groups = malloc((size_t)output->offsets[partition_count] * sizeof(agg_group_t));
+        if (!output->groups)
+            goto out;
+    }
+    for (int i = 0; i < thread_count; i++) {
+        workers[i].table = malloc(table_size_for(max_count) * sizeof(agg_group_t));
+        if (!workers[i].table) {
+            fprintf(stderr, "Error allocating aggregation tables.\n");
+            goto out;
+        }
+    }
+
+    agg_ctx_t ctx = {
+        .set = &set,
+        .workers = workers,
+        .output = output,
+        .group_counts = group_counts,
+        .checksums = checksums,
+    };
+    if (run_tasks(thread_count, partition_count, aggregate_partition, &ctx) != 0)
+        goto out;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+
+    memset(result, 0, sizeof(*result));
+    for (int p = 0; p < partition_count; p++) {
+        result->groups += group_counts[p];
+        result->checksum += checksums[p];
+    }
+    result->partition_ms = elapsed_ms(&start, &partitioned);
+    result->aggregate_ms = elapsed_ms(&partitioned, &end);
+    result->throughput = ((double)tuple_count / (elapsed_ms(&start, &end) / 1000.0)) / 1e6;
+    ret = 0;
+
+out:
+    if (ret != 0 && output)
+        agg_output_free(output);
+    if (workers) {
+        for (int i = 0; i < thread_count; i++)
+            free(workers[i].table);
+        free(workers);
+    }
+    free(group_counts);
+    free(checksums);
+    partition_set_free(&set);
+    return ret;
+}
+
+static void *aggregate_global(void *void_args) {
+    global_args_t *args = (global_args_t *)void_args;
+    global_slot_t *table = args->table;
+
+    set_affinity(args->thread_id);
+
+    for (int i = args->tuples_index; i < args->tuples_length; i++) {
+        uint64_t key = load_u64(args->tuples[i].key);
+        uint32_t b = hash_key(args->tuples[i].key) & args->mask;
+        for (;;) {
+            int state = __atomic_load_n(&table[b].state, __ATOMIC_ACQUIRE);
+            if (state == 0) {
+                int expected = 0;
+                if (__atomic_compare_exchange_n(&table[b].state, &expected, 1, 0, __ATOMIC_ACQ_REL,
+                                                __ATOMIC_ACQUIRE)) {
+                    table[b].key = key;
+                    __atomic_store_n(&table[b].state, 2, __ATOMIC_RELEASE);
+                    state = 2;
+                } else {
+                    state = expected;
+                }
+            }
+            // Another thread is publishing this slot's key.
+            while (state == 1)
+                state = __atomic_load_n(&table[b].state, __ATOMIC_ACQUIRE);
+            if (table[b].key == key)
+                break;
+            b = (b + 1) & args->mask;
+        }
+        __atomic_fetch_add(&table[b].count, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&table[b].sum, load_u64(args->tuples[i].value), __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+int run_global_aggregate_timed(tuple_t *tuples, int tuple_count, int thread_count, agg_result_t *result) {
+    if (!tuples || !result)
+        return -1;
+
+    uint32_t table_size = table_size_for(tuple_count);
+    global_slot_t *table = calloc(table_size, sizeof(global_slot_t));
+    pthread_t *threads = malloc(thread_count * sizeof(pthread_t));
+    global_args_t *args = malloc(thread_count * sizeof(global_args_t));
+    if (!table || !threads || !args) {
+        fprintf(stderr, "Error allocating the global aggregation table.\n");
+        free(table);
+        free(threads);
+        free(args);
+        return -1;
+    }
+
+    struct timespec start, end;
+    int base_segment_size = tuple_count / thread_count;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    for (int i = 0; i < thread_count; i++) {
+        int start_index = base_segment_size * i;
+        args[i].thread_id = i + 1;
+        args[i].tuples = tuples;
+        args[i].tuples_index = start_index;
+        args[i].tuples_length = (i == thread_count - 1) ? tuple_count : (start_index + base_segment_size);
+        args[i].table = table;
+        args[i].mask = table_size - 1;
+        pthread_create(&threads[i], NULL, aggregate_global, &args[i]);
+    }
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+
+    memset(result, 0, sizeof(*result));
+    for (uint32_t b = 0; b < table_size; b++) {
+        if (table[b].state == 2) {
+            result->groups++;
+            result->checksum += table[b].sum;
+        }
+    }
+    result->aggregate_ms = elapsed_ms(&start, &end);
+    result->throughput = ((double)tuple_count / (result->aggregate_ms / 1000.0)) / 1e6;
+
+    free(table);
+    free(threads);
+    free(args);
+    return 0;
+}
+
+void agg_output_free(agg_output_t *output) {
+    free(output->groups);
+    free(output->offsets);
+    free(output->counts);
+    memset(output, 0, sizeof(*output));
+}
@@ -0,0 +1,41 @@
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include <stdint.h>
+#include "project.h"
+#include "partitions.h"
+
+// One GROUP BY key with COUNT(*) and SUM(value), values read as 64-bit integers.
+typedef struct {
+    uint64_t key;
+    uint64_t count;
+    uint64_t sum;
+} agg_group_t;
+
+// Aggregation output: the groups of partition p are groups[offsets[p] .. offsets[p] + counts[p]).
+typedef struct {
+    int partition_count;
+    agg_group_t *groups;
+    int *offsets;
+    int *counts;
+} agg_output_t;
+
+typedef struct {
+    double partition_ms;   // Wall time of the partitioning stage (0 for the global baseline).
+    double aggregate_ms;   // Wall time of the aggregation stage.
+    long long groups;      // Number of distinct keys.
+    uint64_t checksum;     // Sum of all group sums, to cross-check the two approaches.
+    double throughput;     // Millions of input tuples per second, end-to-end.
+} agg_result_t;
+
+// Partitions tuples with the given strategy and aggregates every partition independently in an
+// open-addressing table sized from the partition's tuple count. output may be NULL.
+int run_partitioned_aggregate_timed(tuple_t *tuples, int tuple_count, int thread_count, int hash_bits,
+                                    strategy_t strategy, agg_output_t *output, agg_result_t *result);
+
+// Baseline: all threads aggregate into one shared open-addressing table with atomic updates.
+int run_global_aggregate_timed(tuple_t *tuples, int tuple_count, int thread_count, agg_result_t *result);
+
+void agg_output_free(agg_output_t *output);
+
+#endif
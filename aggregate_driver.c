@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "aggregate.h"
+#include "partitions.h"
+#include "project.h"
+#include "tuples.h"
+
+#define TUPLE_COUNT (1 << 24)  // ~16 million tuples
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS> [independent|concurrent] [GROUPS]\n", argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[1]);
+    int hash_bits = atoi(argv[2]);
+    strategy_t strategy = STRATEGY_INDEPENDENT;
+    if (argc > 3 && parse_strategy(argv[3], &strategy) != 0) {
+        fprintf(stderr, "Unknown strategy '%s'\n", argv[3]);
+        return -1;
+    }
+    // GROUPS = 0 keeps the random (practically distinct) keys.
+    unsigned long long group_count = argc > 4 ? strtoull(argv[4], NULL, 10) : 0;
+
+    tuple_t *tuples = generate_tuples(TUPLE_COUNT);
+    if (!tuples) {
+        fprintf(stderr, "Error generating tuples.\n");
+        return -1;
+    }
+    if (group_count > 0) {
+        for (int i = 0; i < TUPLE_COUNT; i++) {
+            unsigned long long key;
+            memcpy(&key, tuples[i].key, sizeof(key));
+            key %= group_count;
+            memcpy(tuples[i].key, &key, sizeof(key));
+        }
+    }
+
+    agg_result_t partitioned, global;
+    if (run_partitioned_aggregate_timed(tuples, TUPLE_COUNT, thread_count, hash_bits, strategy, NULL,
+                                        &partitioned) != 0 ||
+        run_global_aggregate_timed(tuples, TUPLE_COUNT, thread_count, &global) != 0) {
+        fprintf(stderr, "Error in %s aggregation with %d threads and %d hashbits\n", strategy_name(strategy),
+                thread_count, hash_bits);
+    } else {
+        if (partitioned.groups != global.groups || partitioned.checksum != global.checksum)
+            fprintf(stderr, "Aggregation mismatch: %lld vs %lld groups\n", partitioned.groups, global.groups);
+        printf("Threads,HashBits,Strategy,Groups,Throughput,PartitionMs,AggregateMs,GlobalThroughput\n");
+        printf("%d,%d,%s,%lld,%.2f,%.1f,%.1f,%.2f\n", thread_count, hash_bits, strategy_name(strategy),
+               partitioned.groups, partitioned.throughput, partitioned.partition_ms, partitioned.aggregate_ms,
+               global.throughput);
+    }
+
+    free(tuples);
+    return 0;
+}
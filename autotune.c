@@ -0,0 +1,274 @@
+#define _GNU_SOURCE
+#include "project.h"
+#include "utils.h"
+#include "tuples.h"
+#include "partitions.h"
+#include "repartition.h"
+#include "autotune.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_CACHE_PATH "build/autotune.cache"
+#define CALIBRATION_MAX_BITS 22       // Calibrate on at most ~4M tuples.
+#define MIN_TUPLES_PER_THREAD (1 << 16)
+#define CALIBRATION_REPEAT 2
+#define DEFAULT_DTLB_ENTRIES 64
+
+static long parse_cache_size(const char *text) {
+    char *end;
+    long size = strtol(text, &end, 10);
+    if (*end == 'K')
+        size *= 1024;
+    else if (*end == 'M')
+        size *= 1024 * 1024;
+    return size;
+}
+
+void read_machine_info(machine_info_t *info) {
+    memset(info, 0, sizeof(*info));
+    info->core_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (info->core_count < 1)
+        info->core_count = 1;
+
+    for (int index = 0; index < 8; index++) {
+        char path[128], level[16] = "", type[32] = "", size[32] = "";
+        FILE *f;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+        if (!(f = fopen(path, "r")))
+            break;
+        if (!fgets(level, sizeof(level), f))
+            level[0] = '\0';
+        fclose(f);
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+        if ((f = fopen(path, "r"))) {
+            if (!fgets(type, sizeof(type), f))
+                type[0] = '\0';
+            fclose(f);
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+        if ((f = fopen(path, "r"))) {
+            if (!fgets(size, sizeof(size), f))
+                size[0] = '\0';
+            fclose(f);
+        }
+        if (strncmp(type, "Instruction", 11) == 0)
+            continue;
+        long bytes = parse_cache_size(size);
+        if (atoi(level) == 1)
+            info->l1d_bytes = bytes;
+        else if (atoi(level) == 2)
+            info->l2_bytes = bytes;
+        else if (atoi(level) == 3)
+            info->l3_bytes = bytes;
+    }
+
+    // Linux does not export TLB geometry in sysfs; some CPUs report it in /proc/cpuinfo.
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (f) {
+        char line[256];
+        while (fgets(line, sizeof(line), f)) {
+            if (strncmp(line, "TLB size", 8) == 0) {
+                char *colon = strchr(line, ':');
+                if (colon)
+                    info->dtlb_entries = atoi(colon + 1);
+                break;
+            }
+        }
+        fclose(f);
+    }
+}
+
+int autotune_candidates(const machine_info_t *info, int tuple_count, int hash_bits, tuning_choice_t *candidates,
+                        int max_candidates) {
+    int max_threads = info->core_count;
+    if (max_threads > tuple_count / MIN_TUPLES_PER_THREAD)
+        max_threads = tuple_count / MIN_TUPLES_PER_THREAD;
+    if (max_threads < 1)
+        max_threads = 1;
+
+    // A second pass only pays off once one output cache line per partition no longer fits
+    // in L1 or the partitions outnumber the data TLB entries.
+    long partition_count = 1L << hash_bits;
+    int dtlb_entries = info->dtlb_entries > 0 ? info->dtlb_entries : DEFAULT_DTLB_ENTRIES;
+    int max_passes = 1;
+    if (hash_bits >= 2 && (partition_count * 64 > info->l1d_bytes || partition_count > dtlb_entries))
+        max_passes = 2;
+
+    // Powers of two below the core count, plus the core count itself.
+    int thread_counts[32];
+    int thread_options = 0;
+    for (int t = 1; t < max_threads; t *= 2)
+        thread_counts[thread_options++] = t;
+    thread_counts[thread_options++] = max_threads;
+
+    int n = 0;
+    for (int s = 0; s < 2; s++) {
+        for (int t = 0; t < thread_options; t++) {
+            for (int passes = 1; passes <= max_passes; passes++) {
+                if (n == max_candidates)
+                    return n;
+                candidates[n].strategy = s == 0 ? STRATEGY_INDEPENDENT : STRATEGY_CONCURRENT;
+                candidates[n].thread_count = thread_counts[t];
+                candidates[n].passes = passes;
+                candidates[n].throughput = 0.0;
+                n++;
+            }
+        }
+    }
+    return n;
+}
+
+int autotune_all_configurations(const machine_info_t *info, int hash_bits, tuning_choice_t *configs,
+                                int max_configs) {
+    int max_passes = hash_bits >= 2 ? 2 : 1;
+    int n = 0;
+    for (int s = 0; s < 2; s++) {
+        for (int threads = 1; threads <= info->core_count; threads++) {
+            for (int passes = 1; passes <= max_passes; passes++) {
+                if (n == max_configs)
+                    return n;
+                configs[n].strategy = s == 0 ? STRATEGY_INDEPENDENT : STRATEGY_CONCURRENT;
+                configs[n].thread_count = threads;
+                configs[n].passes = passes;
+                configs[n].throughput = 0.0;
+                n++;
+            }
+        }
+    }
+    return n;
+}
+
+int run_tuned_timed(tuple_t *tuples, int tuple_count, int hash_bits, const tuning_choice_t *choice,
+                    partition_set_t *out, double *throughput) {
+    struct timespec start, end;
+    double kernel_throughput;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+
+    if (choice->passes <= 1) {
+        if (partition_set_init(out, choice->strategy, tuple_count, choice->thread_count, hash_bits) != 0)
+            return -1;
+        if (run_strategy_timed(out, tuples, tuple_count, choice->thread_count, &kernel_throughput, NULL) != 0) {
+            partition_set_free(out);
+            return -1;
+        }
+    } else {
+        partition_set_t first;
+        int first_bits = (hash_bits + 1) / 2;
+        if (partition_set_init(&first, choice->strategy, tuple_count, choice->thread_count, first_bits) != 0)
+            return -1;
+        int ret = run_strategy_timed(&first, tuples, tuple_count, choice->thread_count, &kernel_throughput, NULL);
+        if (ret == 0)
+            ret = refine_partitions(&first, hash_bits - first_bits, choice->thread_count, out);
+        partition_set_free(&first);
+        if (ret != 0)
+            return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+    *throughput = ((double)tuple_count / (elapsed_ms(&start, &end) / 1000.0)) / 1e6;
+    return 0;
+}
+
+static const char *cache_path(void) {
+    const char *path = getenv("PARTITION_AUTOTUNE_CACHE");
+    return path && *path ? path : DEFAULT_CACHE_PATH;
+}
+
+static void format_machine(const machine_info_t *info, char *buf, size_t len) {
+    snprintf(buf, len, "# machine cores=%d l1d=%ld l2=%ld l3=%ld dtlb=%d\n", info->core_count, info->l1d_bytes,
+             info->l2_bytes, info->l3_bytes, info->dtlb_entries);
+}
+
+// Looks up (hash_bits, size_bits) in the cache file. Returns 1 when found, 0 when missing,
+// and -1 when the file belongs to another machine and has to be rebuilt.
+static int load_choice(const char *machine, int hash_bits, int size_bits, tuning_choice_t *choice) {
+    FILE *f = fopen(cache_path(), "r");
+    if (!f)
+        return 0;
+
+    char line[256];
+    int found = 0;
+    if (!fgets(line, sizeof(line), f) || strcmp(line, machine) != 0) {
+        fclose(f);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        int hb, sb, threads, passes;
+        char strategy[32];
+        double throughput;
+        if (sscanf(line, "%d,%d,%31[^,],%d,%d,%lf", &hb, &sb, strategy, &threads, &passes, &throughput) != 6)
+            continue;
+        if (hb != hash_bits || sb != size_bits || parse_strategy(strategy, &choice->strategy) != 0)
+            continue;
+        choice->thread_count = threads;
+        choice->passes = passes;
+        choice->throughput = throughput;
+        found = 1;  // Later lines override earlier ones.
+    }
+    fclose(f);
+    return found;
+}
+
+static void store_choice(const char *machine, int rebuild, int hash_bits, int size_bits,
+                         const tuning_choice_t *choice) {
+    FILE *f = fopen(cache_path(), rebuild ? "w" : "a");
+    if (!f) {
+        fprintf(stderr, "Cannot write autotune cache %s\n", cache_path());
+        return;
+    }
+    if (rebuild || ftell(f) == 0)
+        fputs(machine, f);
+    fprintf(f, "%d,%d,%s,%d,%d,%.2f\n", hash_bits, size_bits, strategy_name(choice->strategy),
+            choice->thread_count, choice->passes, choice->throughput);
+    fclose(f);
+}
+
+int autotune_choose(int tuple_count, int hash_bits, tuning_choice_t *choice) {
+    if (tuple_count <= 0 || hash_bits < 1 || !choice)
+        return -1;
+
+    machine_info_t info;
+    char machine[256];
+    read_machine_info(&info);
+    format_machine(&info, machine, sizeof(machine));
+
+    // Calibrate at the requested size, capped so that calibration stays short.
+    int size_bits = 0;
+    while (size_bits < CALIBRATION_MAX_BITS && (2 << size_bits) <= tuple_count)
+        size_bits++;
+
+    int found = load_choice(machine, hash_bits, size_bits, choice);
+    if (found == 1)
+        return 0;
+
+    tuning_choice_t candidates[AUTOTUNE_MAX_CANDIDATES];
+    int calibration_count = 1 << size_bits;
+    int n = autotune_candidates(&info, calibration_count, hash_bits, candidates, AUTOTUNE_MAX_CANDIDATES);
+    tuple_t *tuples = generate_tuples(calibration_count);
+    if (!tuples)
+        return -1;
+
+    int best = -1;
+    for (int i = 0; i < n; i++) {
+        for (int r = 0; r < CALIBRATION_REPEAT; r++) {
+            partition_set_t out;
+            double throughput;
+            if (run_tuned_timed(tuples, calibration_count, hash_bits, &candidates[i], &out, &throughput) != 0)
+                continue;
+            partition_set_free(&out);
+            if (throughput > candidates[i].throughput)
+                candidates[i].throughput = throughput;
+        }
+        if (best < 0 || candidates[i].throughput > candidates[best].throughput)
+            best = i;
+    }
+    free(tuples);
+    if (best < 0)
+        return -1;
+
+    *choice = candidates[best];
+    store_choice(machine, found < 0, hash_bits, size_bits, choice);
+    return 0;
+}
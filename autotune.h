@@ -0,0 +1,51 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include "project.h"
+#include "partitions.h"
+
+// Hardware facts the tuner bases its candidate set on. Unknown values are 0.
+typedef struct {
+    long l1d_bytes;
+    long l2_bytes;
+    long l3_bytes;
+    int dtlb_entries;
+    int core_count;
+} machine_info_t;
+
+// A tuned configuration. Two passes partition on half the bits first and then split
+// every partition on the remaining bits (see refine_partitions).
+typedef struct {
+    strategy_t strategy;
+    int thread_count;
+    int passes;
+    double throughput;   // Calibrated end-to-end throughput (millions of tuples/sec).
+} tuning_choice_t;
+
+// Reads cache sizes from sysfs, the data TLB size from /proc/cpuinfo where the kernel
+// reports it, and the online core count.
+void read_machine_info(machine_info_t *info);
+
+// Lists the configurations worth trying for a fan-out of 2^hash_bits. Returns how many were
+// written to candidates (at most max_candidates).
+#define AUTOTUNE_MAX_CANDIDATES 64
+int autotune_candidates(const machine_info_t *info, int tuple_count, int hash_bits, tuning_choice_t *candidates,
+                        int max_candidates);
+
+// Lists every configuration, without the pruning above: both strategies, each thread count from
+// 1 to the core count, and one or (from 2 hash bits) two passes. That is at most
+// 4 * info->core_count entries; returns how many were written to configs (at most max_configs).
+int autotune_all_configurations(const machine_info_t *info, int hash_bits, tuning_choice_t *configs,
+                                int max_configs);
+
+// Picks a configuration for tuple_count tuples and a fan-out of 2^hash_bits. Decisions are cached
+// in a table on disk (PARTITION_AUTOTUNE_CACHE, default build/autotune.cache); a missing entry is
+// calibrated by timing every candidate on a short generated input and then stored.
+int autotune_choose(int tuple_count, int hash_bits, tuning_choice_t *choice);
+
+// Runs one configuration end-to-end into out (released with partition_set_free) and reports
+// the wall-clock throughput.
+int run_tuned_timed(tuple_t *tuples, int tuple_count, int hash_bits, const tuning_choice_t *choice,
+                    partition_set_t *out, double *throughput);
+
+#endif
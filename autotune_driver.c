@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "autotune.h"
+#include "partitions.h"
+#include "project.h"
+#include "tuples.h"
+
+#define DEFAULT_TUPLE_BITS 24  // ~16 million tuples
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <HASHBITS> [LOG2_TUPLES]\n", argv[0]);
+        return -1;
+    }
+    int hash_bits = atoi(argv[1]);
+    int tuple_bits = argc > 2 ? atoi(argv[2]) : DEFAULT_TUPLE_BITS;
+    int tuple_count = 1 << tuple_bits;
+
+    tuning_choice_t tuned;
+    if (autotune_choose(tuple_count, hash_bits, &tuned) != 0) {
+        fprintf(stderr, "Autotuning failed for %d hashbits\n", hash_bits);
+        return -1;
+    }
+
+    tuple_t *tuples = generate_tuples(tuple_count);
+    if (!tuples) {
+        fprintf(stderr, "Error generating tuples.\n");
+        return -1;
+    }
+
+    // Exhaustive sweep at the full size, to rate the tuned choice: every configuration, including
+    // those autotune_candidates prunes, so a pruning mistake shows up as a lower PercentOfBest.
+    machine_info_t info;
+    read_machine_info(&info);
+    int max_configs = 4 * info.core_count;
+    tuning_choice_t *candidates = malloc(max_configs * sizeof(tuning_choice_t));
+    if (!candidates) {
+        fprintf(stderr, "Error allocating configurations.\n");
+        free(tuples);
+        return -1;
+    }
+    int n = autotune_all_configurations(&info, hash_bits, candidates, max_configs);
+    int best = -1;
+    double tuned_throughput = 0.0;
+    for (int i = 0; i < n; i++) {
+        partition_set_t out;
+        if (run_tuned_timed(tuples, tuple_count, hash_bits, &candidates[i], &out, &candidates[i].throughput) != 0)
+            continue;
+        partition_set_free(&out);
+        if (best < 0 || candidates[i].throughput > candidates[best].throughput)
+            best = i;
+        if (candidates[i].strategy == tuned.strategy && candidates[i].thread_count == tuned.thread_count &&
+            candidates[i].passes == tuned.passes)
+            tuned_throughput = candidates[i].throughput;
+    }
+    if (best < 0) {
+        fprintf(stderr, "Error in exhaustive sweep with %d hashbits\n", hash_bits);
+        free(candidates);
+        free(tuples);
+        return -1;
+    }
+
+    printf("HashBits,Tuples,Strategy,Threads,Passes,Throughput,BestStrategy,BestThreads,BestPasses,BestThroughput,"
+           "PercentOfBest\n");
+    printf("%d,%d,%s,%d,%d,%.2f,%s,%d,%d,%.2f,%.1f\n", hash_bits, tuple_count, strategy_name(tuned.strategy),
+           tuned.thread_count, tuned.passes, tuned_throughput, strategy_name(candidates[best].strategy),
+           candidates[best].thread_count, candidates[best].passes, candidates[best].throughput,
+           100.0 * tuned_throughput / candidates[best].throughput);
+
+    free(candidates);
+    free(tuples);
+    return 0;
+}
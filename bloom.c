@@ -0,0 +1,64 @@
+#include "bloom.h"
+#include "trace.h"
+#include <stdlib.h>
+#include <string.h>
+
+int bloom_set_init(bloom_set_t *set, int partition_count, int fragment_count, size_t expected_per_partition,
+                   int bits_per_key) {
+    memset(set, 0, sizeof(*set));
+    if (partition_count <= 0 || fragment_count <= 0 || bits_per_key <= 0)
+        return -1;
+
+    size_t wanted = (expected_per_partition * bits_per_key + 255) / 256;
+    size_t blocks = 1;
+    while (blocks < wanted && blocks < ((size_t)1 << 31))
+        blocks <<= 1;
+    set->partition_count = partition_count;
+    set->fragment_count = fragment_count;
+    set->block_mask = (uint32_t)(blocks - 1);
+    set->blocks = aligned_alloc(sizeof(bloom_block_t), bloom_set_bytes(set));
+    if (!set->blocks)
+        return -1;
+    if (pthread_barrier_init(&set->barrier, NULL, fragment_count) != 0) {
+        free(set->blocks);
+        set->blocks = NULL;
+        return -1;
+    }
+    bloom_set_clear(set);
+    return 0;
+}
+
+void bloom_set_free(bloom_set_t *set) {
+    if (set->blocks)
+        pthread_barrier_destroy(&set->barrier);
+    free(set->blocks);
+    set->blocks = NULL;
+}
+
+void bloom_set_clear(bloom_set_t *set) {
+    memset(set->blocks, 0, bloom_set_bytes(set));
+}
+
+size_t bloom_set_bytes(const bloom_set_t *set) {
+    return (size_t)set->fragment_count * set->partition_count * (set->block_mask + 1) * sizeof(bloom_block_t);
+}
+
+void bloom_set_merge(bloom_set_t *set, int fragment) {
+    if (set->fragment_count == 1)
+        return;
+    pthread_barrier_wait(&set->barrier);
+
+    TRACE_BEGIN("bloom_merge");
+    int begin = (int)((long)set->partition_count * fragment / set->fragment_count);
+    int end = (int)((long)set->partition_count * (fragment + 1) / set->fragment_count);
+    size_t words = (size_t)(set->block_mask + 1) * 8;
+    for (int p = begin; p < end; p++) {
+        uint32_t *merged = bloom_filter(set, 0, p)->words;
+        for (int f = 1; f < set->fragment_count; f++) {
+            const uint32_t *local = bloom_filter(set, f, p)->words;
+            for (size_t w = 0; w < words; w++)
+                merged[w] |= local[w];
+        }
+    }
+    TRACE_END("bloom_merge");
+}
@@ -0,0 +1,79 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "utils.h"
+
+// Split-block Bloom filters, one per partition: a key picks one 32-byte block and sets one
+// bit in each of its eight words, so an insert or a query touches a single cache line.
+typedef struct {
+    uint32_t words[8];
+} bloom_block_t;
+
+// Filters of one partitioning run. Every thread inserts into its own fragment of filters;
+// once all threads are done they OR the fragments into fragment 0, which is what queries read.
+typedef struct bloom_set {
+    int partition_count;
+    int fragment_count;
+    uint32_t block_mask;         // Blocks per filter - 1 (a power of two).
+    bloom_block_t *blocks;       // blocks[(f * partition_count + p) * (block_mask + 1) + b]
+    pthread_barrier_t barrier;   // fragment_count parties, for the merge after scattering.
+} bloom_set_t;
+
+// Sizes each filter for expected_per_partition keys at bits_per_key bits (rounded up to a power
+// of two of blocks). Returns 0 on success, -1 on invalid arguments or allocation failure.
+int bloom_set_init(bloom_set_t *set, int partition_count, int fragment_count, size_t expected_per_partition,
+                   int bits_per_key);
+void bloom_set_free(bloom_set_t *set);
+void bloom_set_clear(bloom_set_t *set);
+size_t bloom_set_bytes(const bloom_set_t *set);
+
+// Called by the thread owning fragment after its last insert: waits for the other threads,
+// then ORs every fragment into fragment 0 for its share of the partitions.
+void bloom_set_merge(bloom_set_t *set, int fragment);
+
+static inline bloom_block_t *bloom_filter(const bloom_set_t *set, int fragment, int partition) {
+    size_t filter = (size_t)fragment * set->partition_count + partition;
+    return set->blocks + filter * (set->block_mask + 1);
+}
+
+// 64-bit mix of the key, independent of the Murmur hash that picks the partition.
+static inline uint64_t bloom_hash(const unsigned char *key) {
+    uint64_t h = load_u64(key);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+
+static const uint32_t bloom_salts[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                        0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+// Block of filter that key hash h maps to; split from the insert so callers can prefetch it.
+static inline bloom_block_t *bloom_block(bloom_block_t *filter, uint32_t block_mask, uint64_t h) {
+    return &filter[(h >> 32) & block_mask];
+}
+
+static inline void bloom_insert_hash(bloom_block_t *block, uint64_t h) {
+    for (int i = 0; i < 8; i++)
+        block->words[i] |= 1U << (((uint32_t)h * bloom_salts[i]) >> 27);
+}
+
+static inline void bloom_insert(bloom_block_t *filter, uint32_t block_mask, const unsigned char *key) {
+    uint64_t h = bloom_hash(key);
+    bloom_insert_hash(bloom_block(filter, block_mask, h), h);
+}
+
+// Probe-side check against the merged filter of partition: 0 means the key was not scattered
+// into it, 1 that it may have been.
+static inline int bloom_query(const bloom_set_t *set, int partition, const unsigned char *key) {
+    uint64_t h = bloom_hash(key);
+    const bloom_block_t *block = &bloom_filter(set, 0, partition)[(h >> 32) & set->block_mask];
+    uint32_t missing = 0;
+    for (int i = 0; i < 8; i++)
+        missing |= ~block->words[i] & (1U << (((uint32_t)h * bloom_salts[i]) >> 27));
+    return missing == 0;
+}
+
+#endif
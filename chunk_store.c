@@ -0,0 +1,119 @@
+#include "chunk_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int chunk_store_init(chunk_store_t *store, int partition_count, int fragment_count, int pool_count) {
+    memset(store, 0, sizeof(*store));
+    store->partition_count = partition_count;
+    store->fragment_count = fragment_count;
+    store->pool_count = pool_count;
+    store->lists = calloc((size_t)partition_count * fragment_count, sizeof(chunk_list_t));
+    store->pools = calloc(pool_count, sizeof(chunk_pool_t));
+    if (!store->lists || !store->pools) {
+        fprintf(stderr, "Error allocating chunk store.\n");
+        chunk_store_free(store);
+        return -1;
+    }
+    return 0;
+}
+
+void chunk_store_free(chunk_store_t *store) {
+    if (store->pools) {
+        for (int i = 0; i < store->pool_count; i++) {
+            for (int s = 0; s < store->pools[i].slab_count; s++)
+                free(store->pools[i].slabs[s]);
+            free(store->pools[i].slabs);
+        }
+    }
+    free(store->pools);
+    free(store->lists);
+    memset(store, 0, sizeof(*store));
+}
+
+void chunk_store_reset(chunk_store_t *store) {
+    memset(store->lists, 0, (size_t)store->partition_count * store->fragment_count * sizeof(chunk_list_t));
+    for (int i = 0; i < store->pool_count; i++) {
+        chunk_pool_t *pool = &store->pools[i];
+        // Keep only the first slab of every pool; the rest are reallocated on demand.
+        for (int s = 1; s < pool->slab_count; s++)
+            free(pool->slabs[s]);
+        pool->slab_count = pool->slab_count > 0 ? 1 : 0;
+        pool->cursor = pool->slab_count ? pool->slabs[0] : NULL;
+        pool->remaining = pool->slab_count ? CHUNK_SLAB_BYTES : 0;
+    }
+}
+
+static void *pool_alloc(chunk_pool_t *pool, size_t bytes) {
+    if (bytes > pool->remaining) {
+        if (pool->slab_count == pool->slab_capacity) {
+            int capacity = pool->slab_capacity ? pool->slab_capacity * 2 : 16;
+            unsigned char **slabs = realloc(pool->slabs, capacity * sizeof(unsigned char *));
+            if (!slabs)
+                return NULL;
+            pool->slabs = slabs;
+            pool->slab_capacity = capacity;
+        }
+        unsigned char *slab = malloc(CHUNK_SLAB_BYTES);
+        if (!slab)
+            return NULL;
+        pool->slabs[pool->slab_count++] = slab;
+        pool->cursor = slab;
+        pool->remaining = CHUNK_SLAB_BYTES;
+    }
+    void *p = pool->cursor;
+    pool->cursor += bytes;
+    pool->remaining -= bytes;
+    return p;
+}
+
+chunk_t *chunk_list_grow(chunk_list_t *list, chunk_pool_t *pool) {
+    size_t bytes = CHUNK_MIN_BYTES;
+    if (list->tail) {
+        bytes = (sizeof(chunk_t) + list->tail->capacity * sizeof(tuple_t)) * 2;
+        if (bytes > CHUNK_MAX_BYTES)
+            bytes = CHUNK_MAX_BYTES;
+    }
+    chunk_t *chunk = pool_alloc(pool, bytes);
+    if (!chunk) {
+        // Running out of memory mid-scatter leaves no consistent way to continue.
+        fprintf(stderr, "Error allocating a %zu byte partition chunk.\n", bytes);
+        abort();
+    }
+    chunk->next = NULL;
+    chunk->count = 0;
+    chunk->capacity = (int)((bytes - sizeof(chunk_t)) / sizeof(tuple_t));
+    if (list->tail)
+        list->tail->next = chunk;
+    else
+        list->head = chunk;
+    list->tail = chunk;
+    return chunk;
+}
+
+long chunk_store_partition_size(const chunk_store_t *store, int partition) {
+    long total = 0;
+    for (int f = 0; f < store->fragment_count; f++) {
+        const chunk_list_t *list = &store->lists[f * store->partition_count + partition];
+        for (const chunk_t *c = list->head; c; c = c->next)
+            total += c->count;
+    }
+    return total;
+}
+
+void chunk_store_copy_partition(const chunk_store_t *store, int partition, tuple_t *out) {
+    for (int f = 0; f < store->fragment_count; f++) {
+        const chunk_list_t *list = &store->lists[f * store->partition_count + partition];
+        for (const chunk_t *c = list->head; c; c = c->next) {
+            memcpy(out, c->tuples, c->count * sizeof(tuple_t));
+            out += c->count;
+        }
+    }
+}
+
+size_t chunk_store_bytes(const chunk_store_t *store) {
+    size_t bytes = 0;
+    for (int i = 0; i < store->pool_count; i++)
+        bytes += (size_t)store->pools[i].slab_count * CHUNK_SLAB_BYTES;
+    return bytes;
+}
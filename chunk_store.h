@@ -0,0 +1,72 @@
+#ifndef CHUNK_STORE_H
+#define CHUNK_STORE_H
+
+#include <stddef.h>
+#include "project.h"
+
+// Chunks double in size from CHUNK_MIN_BYTES up to CHUNK_MAX_BYTES as a partition grows,
+// so small partitions stay small and large ones waste at most one partially filled chunk.
+#define CHUNK_MIN_BYTES 256
+#define CHUNK_MAX_BYTES (64 * 1024)
+// Chunks are carved out of per-thread slabs of this size.
+#define CHUNK_SLAB_BYTES (1024 * 1024)
+
+typedef struct chunk {
+    struct chunk *next;
+    int count;             // Tuples written (or, in the concurrent path, reserved).
+    int capacity;
+    tuple_t tuples[];
+} chunk_t;
+
+// Bump allocator over malloc'ed slabs. Each thread owns one, so chunk allocation never contends.
+typedef struct {
+    unsigned char **slabs;
+    int slab_count;
+    int slab_capacity;
+    unsigned char *cursor;
+    size_t remaining;
+} chunk_pool_t;
+
+// A growable partition: a linked list of chunks.
+typedef struct {
+    chunk_t *head;
+    chunk_t *tail;
+} chunk_list_t;
+
+// Partition p is made of fragment_count lists: lists[f * partition_count + p], with the
+// same fragment layout as partition_set_t.
+typedef struct {
+    int partition_count;
+    int fragment_count;
+    chunk_list_t *lists;
+    chunk_pool_t *pools;
+    int pool_count;
+} chunk_store_t;
+
+int chunk_store_init(chunk_store_t *store, int partition_count, int fragment_count, int pool_count);
+void chunk_store_free(chunk_store_t *store);
+
+// Drops all chunks but keeps the slabs for reuse.
+void chunk_store_reset(chunk_store_t *store);
+
+// Allocates the chunk that follows tail (NULL for the first chunk) and links it into list.
+chunk_t *chunk_list_grow(chunk_list_t *list, chunk_pool_t *pool);
+
+// Appends one tuple; the list must only be written by the owner of pool.
+static inline void chunk_list_append(chunk_list_t *list, chunk_pool_t *pool, const tuple_t *tuple) {
+    chunk_t *tail = list->tail;
+    if (!tail || tail->count == tail->capacity)
+        tail = chunk_list_grow(list, pool);
+    tail->tuples[tail->count++] = *tuple;
+}
+
+// Number of tuples in partition p across its fragments.
+long chunk_store_partition_size(const chunk_store_t *store, int partition);
+
+// Copies partition p into out, which must hold chunk_store_partition_size tuples.
+void chunk_store_copy_partition(const chunk_store_t *store, int partition, tuple_t *out);
+
+// Bytes allocated from the system for chunks.
+size_t chunk_store_bytes(const chunk_store_t *store);
+
+#endif
@@ -0,0 +1,255 @@
+#include "compressed.h"
+#include "tasks.h"
+#include "trace.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static inline int bits_for(uint64_t range) {
+    return range ? 64 - __builtin_clzll(range) : 0;
+}
+
+static inline size_t column_words(uint32_t count, int bits) {
+    return ((size_t)count * bits + 63) / 64;
+}
+
+static void pack_column(uint64_t *words, const uint64_t *values, uint32_t count, int bits) {
+    memset(words, 0, column_words(count, bits) * sizeof(uint64_t));
+    for (uint32_t i = 0; i < count && bits > 0; i++) {
+        size_t bit = (size_t)i * bits;
+        size_t word = bit / 64;
+        int shift = (int)(bit % 64);
+        words[word] |= values[i] << shift;
+        if (shift + bits > 64)
+            words[word + 1] |= values[i] >> (64 - shift);
+    }
+}
+
+// Unpacks count offsets of the given width and adds base. The column is followed by at least
+// one readable word (the next column or the padding word), so the loads past it never fault.
+static inline void unpack_column(const uint64_t *words, uint32_t count, int bits, uint64_t base,
+                                 unsigned char (*out)[8], size_t stride) {
+    uint64_t mask = bits == 64 ? UINT64_MAX : ((uint64_t)1 << bits) - 1;
+    unsigned char *dst = (unsigned char *)out;
+    if (bits == 0) {
+        for (uint32_t i = 0; i < count; i++, dst += stride)
+            memcpy(dst, &base, sizeof(base));
+    } else if (bits <= 57) {
+        // An unaligned 8-byte load at the offset's first byte holds all of its bits, so the
+        // common widths decode without the word-straddle branch.
+        const unsigned char *bytes = (const unsigned char *)words;
+        for (uint32_t i = 0; i < count; i++, dst += stride) {
+            size_t bit = (size_t)i * bits;
+            uint64_t v = base + ((load_u64(bytes + bit / 8) >> (bit % 8)) & mask);
+            memcpy(dst, &v, sizeof(v));
+        }
+    } else {
+        for (uint32_t i = 0; i < count; i++, dst += stride) {
+            size_t bit = (size_t)i * bits;
+            size_t word = bit / 64;
+            int shift = (int)(bit % 64);
+            uint64_t packed = words[word] >> shift;
+            if (shift + bits > 64)
+                packed |= words[word + 1] << (64 - shift);
+            uint64_t v = base + (packed & mask);
+            memcpy(dst, &v, sizeof(v));
+        }
+    }
+}
+
+int compressed_encode(compressed_input_t *input, const tuple_t *tuples, size_t tuple_count) {
+    memset(input, 0, sizeof(*input));
+    input->tuple_count = tuple_count;
+    input->block_count = (tuple_count + COMPRESSED_BLOCK_TUPLES - 1) / COMPRESSED_BLOCK_TUPLES;
+    input->blocks = malloc((input->block_count ? input->block_count : 1) * sizeof(compressed_block_t));
+    uint64_t *keys = malloc(COMPRESSED_BLOCK_TUPLES * sizeof(uint64_t));
+    uint64_t *values = malloc(COMPRESSED_BLOCK_TUPLES * sizeof(uint64_t));
+    if (!input->blocks || !keys || !values)
+        goto fail;
+
+    // First pass: frames and widths, hence every block's offset and the total size.
+    size_t words = 0;
+    for (size_t b = 0; b < input->block_count; b++) {
+        compressed_block_t *block = &input->blocks[b];
+        const tuple_t *first = tuples + b * COMPRESSED_BLOCK_TUPLES;
+        size_t left = tuple_count - b * COMPRESSED_BLOCK_TUPLES;
+        block->count = left < COMPRESSED_BLOCK_TUPLES ? (uint32_t)left : COMPRESSED_BLOCK_TUPLES;
+        uint64_t key_min = UINT64_MAX, key_max = 0, value_min = UINT64_MAX, value_max = 0;
+        for (uint32_t i = 0; i < block->count; i++) {
+            uint64_t key = load_u64(first[i].key), value = load_u64(first[i].value);
+            key_min = key < key_min ? key : key_min;
+            key_max = key > key_max ? key : key_max;
+            value_min = value < value_min ? value : value_min;
+            value_max = value > value_max ? value : value_max;
+        }
+        block->key_base = key_min;
+        block->value_base = value_min;
+        block->key_bits = (uint8_t)bits_for(key_max - key_min);
+        block->value_bits = (uint8_t)bits_for(value_max - value_min);
+        block->offset = words;
+        words += column_words(block->count, block->key_bits) + column_words(block->count, block->value_bits);
+    }
+
+    input->word_count = words + 1;  // Padding word for the last straddle load.
+    input->words = calloc(input->word_count, sizeof(uint64_t));
+    if (!input->words)
+        goto fail;
+    for (size_t b = 0; b < input->block_count; b++) {
+        compressed_block_t *block = &input->blocks[b];
+        const tuple_t *first = tuples + b * COMPRESSED_BLOCK_TUPLES;
+        for (uint32_t i = 0; i < block->count; i++) {
+            keys[i] = load_u64(first[i].key) - block->key_base;
+            values[i] = load_u64(first[i].value) - block->value_base;
+        }
+        uint64_t *column = input->words + block->offset;
+        pack_column(column, keys, block->count, block->key_bits);
+        pack_column(column + column_words(block->count, block->key_bits), values, block->count, block->value_bits);
+    }
+    free(keys);
+    free(values);
+    return 0;
+
+fail:
+    free(keys);
+    free(values);
+    compressed_free(input);
+    return -1;
+}
+
+int compressed_generate_tuples(tuple_t *tuples, size_t tuple_count, int key_bits, int value_bits) {
+    if (tuple_count == 0 || tuple_count > MAX_TUPLES || key_bits < 0 || key_bits > 64 || value_bits < 0 ||
+        value_bits > 64)
+        return -1;
+
+    uint64_t key_mask = key_bits == 64 ? UINT64_MAX : ((uint64_t)1 << key_bits) - 1;
+    uint64_t value_mask = value_bits == 64 ? UINT64_MAX : ((uint64_t)1 << value_bits) - 1;
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    uint64_t key_base = 0;
+    for (size_t i = 0; i < tuple_count; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        if (i % COMPRESSED_BLOCK_TUPLES == 0)
+            key_base = state;
+        uint64_t key = key_base + (state * 0x2545F4914F6CDD1DULL & key_mask);
+        uint64_t value = (state >> 7) & value_mask;
+        memcpy(tuples[i].key, &key, sizeof(key));
+        memcpy(tuples[i].value, &value, sizeof(value));
+    }
+    return 0;
+}
+
+int compressed_generate(compressed_input_t *input, size_t tuple_count, int key_bits, int value_bits) {
+    memset(input, 0, sizeof(*input));
+    if (tuple_count == 0 || tuple_count > MAX_TUPLES)
+        return -1;
+    tuple_t *tuples = malloc(tuple_count * sizeof(tuple_t));
+    if (!tuples)
+        return -1;
+    int ret = compressed_generate_tuples(tuples, tuple_count, key_bits, value_bits);
+    if (ret == 0)
+        ret = compressed_encode(input, tuples, tuple_count);
+    free(tuples);
+    return ret;
+}
+
+void compressed_free(compressed_input_t *input) {
+    free(input->blocks);
+    free(input->words);
+    input->blocks = NULL;
+    input->words = NULL;
+}
+
+size_t compressed_bytes(const compressed_input_t *input) {
+    return input->block_count * sizeof(compressed_block_t) + input->word_count * sizeof(uint64_t);
+}
+
+size_t compressed_decode_block(const compressed_input_t *input, size_t b, tuple_t *out) {
+    const compressed_block_t *block = &input->blocks[b];
+    const uint64_t *column = input->words + block->offset;
+    unpack_column(column, block->count, block->key_bits, block->key_base, &out->key, sizeof(tuple_t));
+    unpack_column(column + column_words(block->count, block->key_bits), block->count, block->value_bits,
+                  block->value_base, &out->value, sizeof(tuple_t));
+    return block->count;
+}
+
+typedef struct {
+    const compressed_input_t *input;
+    int slice_count;
+    tuple_t *tuples;       // Decode target (compressed_decode_all).
+    partition_set_t *set;  // Scatter target (run_compressed_partition_timed).
+} decode_ctx_t;
+
+// Blocks [*begin, *end) of slice.
+static void slice_blocks(const decode_ctx_t *ctx, int slice, size_t *begin, size_t *end) {
+    size_t per_slice = ctx->input->block_count / ctx->slice_count;
+    *begin = per_slice * slice;
+    *end = slice == ctx->slice_count - 1 ? ctx->input->block_count : *begin + per_slice;
+}
+
+static void decode_slice(int slice, int worker_id, void *void_ctx) {
+    (void)worker_id;
+    decode_ctx_t *ctx = (decode_ctx_t *)void_ctx;
+    size_t begin, end;
+    slice_blocks(ctx, slice, &begin, &end);
+    TRACE_BEGIN("decode");
+    for (size_t b = begin; b < end; b++)
+        compressed_decode_block(ctx->input, b, ctx->tuples + b * COMPRESSED_BLOCK_TUPLES);
+    TRACE_END("decode");
+}
+
+static void decode_scatter_slice(int slice, int worker_id, void *void_ctx) {
+    (void)worker_id;
+    decode_ctx_t *ctx = (decode_ctx_t *)void_ctx;
+    partition_set_t *set = ctx->set;
+    tuple_t **buffers = set->buffers + (size_t)slice * set->partition_count;
+    size_t *sizes = set->sizes + (size_t)slice * set->partition_count;
+    int partition_count = set->partition_count;
+    size_t capacity = set->capacity;
+    tuple_t window[COMPRESSED_BLOCK_TUPLES];
+    size_t begin, end, dropped = 0;
+    slice_blocks(ctx, slice, &begin, &end);
+
+    TRACE_BEGIN("scatter");
+    for (size_t b = begin; b < end; b++) {
+        size_t count = compressed_decode_block(ctx->input, b, window);
+        for (size_t i = 0; i < count; i++) {
+            int p = hash_to_partition(window[i].key, partition_count);
+            size_t idx = sizes[p];
+            if (idx >= capacity) {
+                dropped++;
+                continue;
+            }
+            buffers[p][idx] = window[i];
+            sizes[p] = idx + 1;
+        }
+    }
+    TRACE_END("scatter");
+    if (dropped)
+        fprintf(stderr, "Slice %d: %zu tuples dropped on partition overflow\n", slice, dropped);
+}
+
+int compressed_decode_all(const compressed_input_t *input, tuple_t *tuples, int thread_count) {
+    if (!input || !tuples || thread_count < 1)
+        return -1;
+    decode_ctx_t ctx = {input, thread_count, tuples, NULL};
+    return run_tasks(thread_count, thread_count, decode_slice, &ctx);
+}
+
+int run_compressed_partition_timed(const compressed_input_t *input, int thread_count, partition_set_t *set,
+                                   double *throughput) {
+    if (!input || thread_count < 1 || set->strategy != STRATEGY_INDEPENDENT || set->fragment_count != thread_count)
+        return -1;
+    memset(set->sizes, 0, (size_t)set->fragment_count * set->partition_count * sizeof(size_t));
+
+    decode_ctx_t ctx = {input, thread_count, NULL, set};
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    int ret = run_tasks(thread_count, thread_count, decode_scatter_slice, &ctx);
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+    if (ret == 0)
+        *throughput = ((double)input->tuple_count / (elapsed_ms(&start, &end) / 1000.0)) / 1e6;
+    return ret;
+}
@@ -0,0 +1,64 @@
+#ifndef COMPRESSED_H
+#define COMPRESSED_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "partitions.h"
+#include "project.h"
+
+// Block-compressed tuples. Every block of up to COMPRESSED_BLOCK_TUPLES tuples stores its keys
+// and its values as frame-of-reference columns: the block minimum plus a bit-packed offset of
+// key_bits (value_bits) bits per tuple, so a block of tuples decodes into a small,
+// cache-resident window.
+#define COMPRESSED_BLOCK_TUPLES 1024
+
+typedef struct {
+    uint64_t key_base;
+    uint64_t value_base;
+    size_t offset;            // First word of the block in compressed_input_t.words.
+    uint32_t count;
+    uint8_t key_bits;         // 0 to 64; the value column starts right after the key column.
+    uint8_t value_bits;
+} compressed_block_t;
+
+typedef struct {
+    size_t tuple_count;
+    size_t block_count;
+    compressed_block_t *blocks;
+    uint64_t *words;
+    size_t word_count;
+} compressed_input_t;
+
+// Compresses tuple_count tuples, keys and values read as integers (load_u64). Returns 0 on
+// success, -1 on allocation failure.
+int compressed_encode(compressed_input_t *input, const tuple_t *tuples, size_t tuple_count);
+
+// Generates compressible tuples: each block draws its keys from a random base plus key_bits
+// random bits and its values from value_bits random bits. Returns 0 on success, -1 on invalid
+// arguments.
+int compressed_generate_tuples(tuple_t *tuples, size_t tuple_count, int key_bits, int value_bits);
+
+// Generates such tuples and compresses them into input. Returns 0 on success, -1 on invalid
+// arguments or allocation failure.
+int compressed_generate(compressed_input_t *input, size_t tuple_count, int key_bits, int value_bits);
+
+void compressed_free(compressed_input_t *input);
+
+size_t compressed_bytes(const compressed_input_t *input);
+
+// Decodes block b into out, which has room for COMPRESSED_BLOCK_TUPLES tuples. Returns the
+// number of tuples decoded.
+size_t compressed_decode_block(const compressed_input_t *input, size_t b, tuple_t *out);
+
+// Decompress-then-partition baseline, first half: decodes the whole input into tuples
+// (input->tuple_count entries), with the blocks split across threads.
+int compressed_decode_all(const compressed_input_t *input, tuple_t *tuples, int thread_count);
+
+// Fused path: every thread decodes its share of the blocks one at a time into a window and
+// scatters the window straight into its fragment of set (independent strategy, one fragment
+// per thread), so decoded tuples never go back to memory. throughput is millions of tuples per
+// second of wall time. Returns 0 on success, -1 on an invalid set.
+int run_compressed_partition_timed(const compressed_input_t *input, int thread_count, partition_set_t *set,
+                                   double *throughput);
+
+#endif
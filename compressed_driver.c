@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "compressed.h"
+#include "partitions.h"
+#include "project.h"
+#include "utils.h"
+
+#define TUPLE_COUNT (1 << 24)  // ~16 million tuples
+#define DEFAULT_KEY_BITS 24
+#define DEFAULT_VALUE_BITS 16
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS> [KEY_BITS] [VALUE_BITS]\n", argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[1]);
+    int hash_bits = atoi(argv[2]);
+    int key_bits = argc > 3 ? atoi(argv[3]) : DEFAULT_KEY_BITS;
+    int value_bits = argc > 4 ? atoi(argv[4]) : DEFAULT_VALUE_BITS;
+
+    // The source tuples are kept until the decoded ones have been checked against them.
+    compressed_input_t input = {0};
+    tuple_t *source = malloc((size_t)TUPLE_COUNT * sizeof(tuple_t));
+    if (!source || compressed_generate_tuples(source, TUPLE_COUNT, key_bits, value_bits) != 0 ||
+        compressed_encode(&input, source, TUPLE_COUNT) != 0) {
+        fprintf(stderr, "Error generating compressed input.\n");
+        free(source);
+        compressed_free(&input);
+        return -1;
+    }
+    tuple_t *tuples = malloc((size_t)TUPLE_COUNT * sizeof(tuple_t));
+    partition_set_t two_pass = {0}, fused = {0};
+    int status = -1;
+    if (!tuples || partition_set_init(&two_pass, STRATEGY_INDEPENDENT, TUPLE_COUNT, thread_count, hash_bits) != 0 ||
+        partition_set_init(&fused, STRATEGY_INDEPENDENT, TUPLE_COUNT, thread_count, hash_bits) != 0) {
+        fprintf(stderr, "Error allocating buffers.\n");
+        goto out;
+    }
+
+    // Baseline: decode everything into a tuple array, then partition that array. The array is
+    // touched beforehand so that page faults are not billed to the decode.
+    memset(tuples, 0, (size_t)TUPLE_COUNT * sizeof(tuple_t));
+    struct timespec start, decoded, partitioned;
+    double throughput;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    if (compressed_decode_all(&input, tuples, thread_count) != 0)
+        goto out;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &decoded);
+    if (run_strategy_timed(&two_pass, tuples, TUPLE_COUNT, thread_count, &throughput, NULL) != 0)
+        goto out;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &partitioned);
+    if (memcmp(tuples, source, (size_t)TUPLE_COUNT * sizeof(tuple_t)) != 0) {
+        fprintf(stderr, "Decoded tuples differ from the encoded ones.\n");
+        goto out;
+    }
+    free(source);
+    source = NULL;
+
+    // The two-pass partitions hold the verified input, so the fused ones must hold the same tuples.
+    double fused_throughput;
+    if (run_compressed_partition_timed(&input, thread_count, &fused, &fused_throughput) != 0)
+        goto out;
+    for (int p = 0; p < fused.partition_count; p++) {
+        if (partition_set_total(&fused, p) != partition_set_total(&two_pass, p) ||
+            partition_set_checksum(&fused, p) != partition_set_checksum(&two_pass, p)) {
+            fprintf(stderr, "Partition %d differs between the fused and the two-pass run.\n", p);
+            goto out;
+        }
+    }
+
+    double decode_ms = elapsed_ms(&start, &decoded);
+    double partition_ms = elapsed_ms(&decoded, &partitioned);
+    double two_pass_throughput = TUPLE_COUNT / ((decode_ms + partition_ms) * 1e3);
+    printf("Threads,HashBits,KeyBits,ValueBits,BytesPerTuple,DecodeMs,PartitionMs,TwoPassMTuples,FusedMTuples,"
+           "Speedup\n");
+    printf("%d,%d,%d,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n", thread_count, hash_bits, key_bits, value_bits,
+           (double)compressed_bytes(&input) / TUPLE_COUNT, decode_ms, partition_ms, two_pass_throughput,
+           fused_throughput, fused_throughput / two_pass_throughput);
+    status = 0;
+
+out:
+    partition_set_free(&fused);
+    partition_set_free(&two_pass);
+    free(tuples);
+    free(source);
+    compressed_free(&input);
+    return status;
+}
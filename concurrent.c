@@ -4,6 +4,12 @@
 #include "affinity.h"
 #include "concurrent.h"
 #include "tuples.h"
+#include "chunk_store.h"
+#include "fanout.h"
+#include "predicate.h"
+#include "scatter.h"
+#include "stats.h"
+#include "trace.h"
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -11,72 +17,144 @@
 typedef struct {
     int thread_id;
     tuple_t *tuples;
-    int tuples_index;
-    int tuples_length;
+    size_t tuples_index;
+    size_t tuples_length;
     int partition_count;
     tuple_t **partitions;
-    int *partition_indexes;
+    size_t *partition_indexes;
+    size_t capacity;
+    int prefetch_distance;          // Software-pipelined scatter when > 0.
+    fanout_concurrent_fn kernel;    // Kernel compiled for this fan-out, or NULL for the generic loop.
+    chunk_list_t *partition_lists;  // Chunked mode: shared growable partitions.
+    chunk_pool_t *pool;             // Chunked mode: this thread's chunk pool.
     pthread_mutex_t *partition_mutexes;
+    const partition_opts_t *opts;   // Bloom filters and statistics to fill while scattering, or NULL.
     struct timespec start;
     struct timespec end;
 } thread_args_t;
 
+// Scatters tuples [begin, end) with the kernel picked for this run: the prefetching pipeline, the
+// kernel compiled for this fan-out, or the generic loop.
+static void scatter_tuples(thread_args_t *args, const tuple_t *tuples, size_t begin, size_t end) {
+    if (args->prefetch_distance > 0) {
+        scatter_concurrent_prefetch(tuples, begin, end, args->partition_count, args->partitions,
+                                    args->partition_indexes, args->partition_mutexes, args->capacity,
+                                    args->prefetch_distance, args->thread_id, args->opts);
+        return;
+    }
+    if (args->kernel) {
+        size_t dropped = args->kernel(tuples, begin, end, args->partitions, args->partition_indexes,
+                                      args->partition_mutexes, args->capacity);
+        if (dropped)
+            fprintf(stderr, "Thread %d: %zu tuples dropped on partition overflow (cap=%zu)\n", args->thread_id,
+                    dropped, args->capacity);
+        return;
+    }
+    // Statistics are thread-local, so they are updated outside the lock and merged at the end.
+    partition_stats_t *stats = args->opts ? args->opts->stats : NULL;
+    stats_fragment_t stats_view = stats ? partition_stats_fragment(stats, args->thread_id - 1) : (stats_fragment_t){0};
+    const range_splitters_t *range = args->opts ? args->opts->range : NULL;
+    for (size_t i = begin; i < end; i++) {
+        uint32_t hash;
+        int partition = scatter_partition(range, stats != NULL, tuples[i].key, args->partition_count, &hash);
+        // The index only advances on a reserved slot, so it never runs past the capacity that
+        // readers of the sizes rely on.
+        TRACE_LOCK(&args->partition_mutexes[partition]);
+        size_t idx = args->partition_indexes[partition];
+        if (idx < args->capacity)
+            args->partition_indexes[partition] = idx + 1;
+        pthread_mutex_unlock(&args->partition_mutexes[partition]);
+        if (idx >= args->capacity) {
+            fprintf(stderr, "Thread %d: Partition %d overflow (idx=%zu, cap=%zu)\n",
+                    args->thread_id, partition, idx, args->capacity);
+            continue;
+        }
+        args->partitions[partition][idx] = tuples[i];
+        if (stats)
+            stats_fragment_add(stats_view, partition, hash, tuples[i].key);
+    }
+}
+
+static void scatter_selected(void *ctx, const tuple_t *tuples, size_t count) {
+    scatter_tuples((thread_args_t *)ctx, tuples, 0, count);
+}
+
 void *write_to_partitions(void *void_args) {
     if (!void_args) return NULL;
     thread_args_t *args = (thread_args_t *)void_args;
 
     set_affinity(args->thread_id);
 
-    if (!args->tuples || !args->partitions || !args->partition_indexes || !args->partition_mutexes)
+    // A thread that bails out still joins the merge barrier (see write_independent_output).
+    if (!args->tuples || !args->partitions || !args->partition_indexes || !args->partition_mutexes) {
+        scatter_opts_finish(args->opts, args->thread_id - 1);
         return NULL;
+    }
 
     clock_gettime(CLOCK_MONOTONIC, &args->start);
-    for (int i = args->tuples_index; i < args->tuples_length; i++) {
-        int partition = hash_to_partition(args->tuples[i].key, args->partition_count);
-        pthread_mutex_lock(&args->partition_mutexes[partition]);
-        int idx = args->partition_indexes[partition]++;
-        pthread_mutex_unlock(&args->partition_mutexes[partition]);
-        args->partitions[partition][idx] = args->tuples[i];
+    TRACE_BEGIN("scatter");
+    const scan_predicate_t *predicate = args->opts ? args->opts->predicate : NULL;
+    if (predicate) {
+        // Qualifying tuples are compacted into a cache-resident batch and scattered from there.
+        predicate_scan(predicate, args->tuples, args->tuples_index, args->tuples_length, scatter_selected, args);
+    } else {
+        scatter_tuples(args, args->tuples, args->tuples_index, args->tuples_length);
     }
+    TRACE_END("scatter");
+    scatter_opts_finish(args->opts, args->thread_id - 1);
     clock_gettime(CLOCK_MONOTONIC, &args->end);
 
     return NULL;
 }
 
-int run_concurrent_timed(tuple_t *tuples, int tuple_count, int thread_count, int partition_count,
-                         tuple_t **global_partition_buffers, int *global_partition_indexes,
-                         int global_capacity, double *throughput) {
-    if (!tuples) return -1;
+// Chunked variant: a slot is reserved under the partition mutex, growing the partition with a
+// chunk from this thread's pool when the tail chunk is full, and written after unlocking.
+void *write_to_chunks(void *void_args) {
+    if (!void_args) return NULL;
+    thread_args_t *args = (thread_args_t *)void_args;
 
-    int effective_capacity = (tuple_count / partition_count) * PARTITION_MULTIPLIER;
-    if (effective_capacity > global_capacity)
-        effective_capacity = global_capacity;
+    set_affinity(args->thread_id);
 
-    for (int i = 0; i < partition_count; i++)
-        global_partition_indexes[i] = 0;
+    if (!args->tuples || !args->partition_lists || !args->pool || !args->partition_mutexes)
+        return NULL;
 
-    pthread_mutex_t *mutexes = malloc(partition_count * sizeof(pthread_mutex_t));
-    if (!mutexes) return -1;
+    clock_gettime(CLOCK_MONOTONIC, &args->start);
+    TRACE_BEGIN("scatter");
+    for (size_t i = args->tuples_index; i < args->tuples_length; i++) {
+        int partition = hash_to_partition(args->tuples[i].key, args->partition_count);
+        chunk_list_t *list = &args->partition_lists[partition];
+        TRACE_LOCK(&args->partition_mutexes[partition]);
+        chunk_t *tail = list->tail;
+        if (!tail || tail->count == tail->capacity)
+            tail = chunk_list_grow(list, args->pool);
+        tuple_t *slot = &tail->tuples[tail->count++];
+        pthread_mutex_unlock(&args->partition_mutexes[partition]);
+        *slot = args->tuples[i];
+    }
+    TRACE_END("scatter");
+    clock_gettime(CLOCK_MONOTONIC, &args->end);
 
-    for (int i = 0; i < partition_count; i++)
-        pthread_mutex_init(&mutexes[i], NULL);
+    return NULL;
+}
 
+// Runs fn on thread_count threads over even slices of the input and computes the throughput
+// from the average per-thread time. args must already hold the mode-specific fields.
+static void run_partition_threads(thread_args_t *args, int thread_count, void *(*fn)(void *), tuple_t *tuples,
+                                  size_t tuple_count, int partition_count, pthread_mutex_t *mutexes,
+                                  double *throughput) {
     pthread_t threads[thread_count];
-    thread_args_t args[thread_count];
-    int base_segment_size = tuple_count / thread_count;
+    size_t base_segment_size = tuple_count / thread_count;
 
     for (int i = 0; i < thread_count; i++) {
-        int start_index = base_segment_size * i;
-        int end_index = (i == thread_count - 1) ? tuple_count : (start_index + base_segment_size);
+        size_t start_index = base_segment_size * i;
+        size_t end_index = (i == thread_count - 1) ? tuple_count : (start_index + base_segment_size);
         args[i].thread_id = i + 1;
         args[i].tuples = tuples;
         args[i].tuples_index = start_index;
         args[i].tuples_length = end_index;
         args[i].partition_count = partition_count;
-        args[i].partitions = global_partition_buffers;
-        args[i].partition_indexes = global_partition_indexes;
         args[i].partition_mutexes = mutexes;
-        pthread_create(&threads[i], NULL, write_to_partitions, &args[i]);
+        pthread_create(&threads[i], NULL, fn, &args[i]);
     }
 
     for (int i = 0; i < thread_count; i++) {
@@ -92,6 +170,78 @@ int run_concurrent_timed(tuple_t *tuples, int tuple_count, int thread_count, int
     avg_time /= thread_count;
 
     *throughput = ((double)tuple_count / (avg_time / 1000.0)) / 1e6;
+}
+
+int run_concurrent_timed(tuple_t *tuples, size_t tuple_count, int thread_count, int partition_count,
+                         tuple_t **global_partition_buffers, size_t *global_partition_indexes,
+                         size_t global_capacity, double *throughput, const partition_opts_t *opts) {
+    if (!tuples) return -1;
+
+    // All of the room the buffers have (see run_independent_timed).
+    size_t effective_capacity = global_capacity;
+
+    for (int i = 0; i < partition_count; i++)
+        global_partition_indexes[i] = 0;
+
+    if (scatter_opts_prepare(opts, partition_count, thread_count) != 0)
+        return -1;
+
+    pthread_mutex_t *mutexes = malloc(partition_count * sizeof(pthread_mutex_t));
+    if (!mutexes) return -1;
+
+    for (int i = 0; i < partition_count; i++)
+        pthread_mutex_init(&mutexes[i], NULL);
+
+    int prefetch_distance = resolve_prefetch_distance(opts, tuples, tuple_count, partition_count);
+    const fanout_kernels_t *kernels = scatter_fanout_kernels(opts, prefetch_distance, partition_count);
+    thread_args_t args[thread_count];
+    for (int i = 0; i < thread_count; i++) {
+        args[i].opts = opts;
+        args[i].partitions = global_partition_buffers;
+        args[i].partition_indexes = global_partition_indexes;
+        args[i].capacity = effective_capacity;
+        args[i].prefetch_distance = prefetch_distance;
+        args[i].kernel = kernels ? kernels->concurrent : NULL;
+        args[i].partition_lists = NULL;
+        args[i].pool = NULL;
+    }
+    run_partition_threads(args, thread_count, write_to_partitions, tuples, tuple_count, partition_count, mutexes,
+                          throughput);
+
+    for (int i = 0; i < partition_count; i++)
+        pthread_mutex_destroy(&mutexes[i]);
+    free(mutexes);
+
+    return 0;
+}
+
+int run_concurrent_chunked_timed(tuple_t *tuples, size_t tuple_count, int thread_count, int partition_count,
+                                 chunk_store_t *store, double *throughput) {
+    if (!tuples || !store) return -1;
+    if (store->partition_count != partition_count || store->fragment_count != 1 ||
+        store->pool_count != thread_count)
+        return -1;
+    chunk_store_reset(store);
+
+    pthread_mutex_t *mutexes = malloc(partition_count * sizeof(pthread_mutex_t));
+    if (!mutexes) return -1;
+
+    for (int i = 0; i < partition_count; i++)
+        pthread_mutex_init(&mutexes[i], NULL);
+
+    thread_args_t args[thread_count];
+    for (int i = 0; i < thread_count; i++) {
+        args[i].partitions = NULL;
+        args[i].partition_indexes = NULL;
+        args[i].capacity = 0;
+        args[i].prefetch_distance = 0;
+        args[i].kernel = NULL;
+        args[i].partition_lists = store->lists;
+        args[i].pool = &store->pools[i];
+        args[i].opts = NULL;
+    }
+    run_partition_threads(args, thread_count, write_to_chunks, tuples, tuple_count, partition_count, mutexes,
+                          throughput);
 
     for (int i = 0; i < partition_count; i++)
         pthread_mutex_destroy(&mutexes[i]);
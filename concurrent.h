@@ -2,9 +2,15 @@
 #define CONCURRENT_H
 
 #include "project.h"
+#include "chunk_store.h"
 
-int run_concurrent_timed(tuple_t *tuples, int tuple_count, int thread_count, int partition_count,
-                         tuple_t **global_partition_buffers, int *global_partition_indexes,
-                         int global_capacity, double *throughput);
+int run_concurrent_timed(tuple_t *tuples, size_t tuple_count, int thread_count, int partition_count,
+                         tuple_t **global_partition_buffers, size_t *global_partition_indexes,
+                         size_t global_capacity, double *throughput, const partition_opts_t *opts);
+
+// Same partitioning into a growable chunk store (a single shared fragment, one chunk pool
+// per thread) instead of fixed-capacity buffers.
+int run_concurrent_chunked_timed(tuple_t *tuples, size_t tuple_count, int thread_count, int partition_count,
+                                 chunk_store_t *store, double *throughput);
 
 #endif
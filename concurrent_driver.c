@@ -1,30 +1,104 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "concurrent.h"
 #include "project.h"
 #include "utils.h"
+#include "scatter.h"
+#include "bloom.h"
+#include "stats.h"
 #include "tuples.h"
 
-#define TUPLE_COUNT (1 << 24)  // ~16 million tuples
+#define DEFAULT_TUPLE_COUNT ((size_t)1 << 24)  // ~16 million tuples; -n overrides it
 
 int main(int argc, char *argv[]) {
-    if (argc < 3) {
-        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS>\n", argv[0]);
+    const char *usage =
+        "Usage: %s [-n LOG2_TUPLES] [-p PREFETCH_DISTANCE|auto] [-b BLOOM_BITS] [-s] [-k] <THREAD_COUNT> "
+        "<HASHBITS> [fixed|chunked]\n";
+    partition_opts_t opts = {0};
+    size_t tuple_count = DEFAULT_TUPLE_COUNT;
+    int bloom_bits = 0;
+    int collect_stats = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:p:b:sk")) != -1) {
+        switch (opt) {
+        case 'n':
+            if (parse_log2_tuples(optarg, &tuple_count) != 0) {
+                fprintf(stderr, "Invalid LOG2_TUPLES '%s'.\n", optarg);
+                return -1;
+            }
+            break;
+        case 'p':
+            opts.prefetch_distance = strcmp(optarg, "auto") == 0 ? -1 : atoi(optarg);
+            break;
+        case 'b':
+            bloom_bits = atoi(optarg);
+            break;
+        case 's':
+            collect_stats = 1;
+            break;
+        case 'k':
+            opts.specialized = 1;
+            break;
+        default:
+            fprintf(stderr, usage, argv[0]);
+            return -1;
+        }
+    }
+    if (argc - optind < 2) {
+        fprintf(stderr, usage, argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[optind]);
+    int hash_bits = atoi(argv[optind + 1]);
+    int chunked = argc - optind > 2 && strcmp(argv[optind + 2], "chunked") == 0;
+    // The chunk store has its own append loop, without prefetching, Bloom filters, statistics or
+    // specialized kernels, so those options would be silently dropped.
+    if (chunked && (opts.prefetch_distance || bloom_bits || collect_stats || opts.specialized)) {
+        fprintf(stderr, "-p, -b, -s and -k are not supported in chunked mode.\n");
+        fprintf(stderr, usage, argv[0]);
         return -1;
     }
-    int thread_count = atoi(argv[1]);
-    int hash_bits = atoi(argv[2]);
 
     // Generate tuples.
-    tuple_t *tuples = generate_tuples(TUPLE_COUNT);
+    tuple_t *tuples = generate_tuples(tuple_count);
     if (!tuples) {
         fprintf(stderr, "Error generating tuples.\n");
         return -1;
     }
 
+    // Tune the prefetch distance once, outside the timed run, and report the choice.
+    if (opts.prefetch_distance < 0) {
+        opts.prefetch_distance = tune_prefetch_distance(tuples, tuple_count, 1 << hash_bits);
+        fprintf(stderr, "Tuned prefetch distance: %d\n", opts.prefetch_distance);
+    }
+
+    if (chunked) {
+        // Growable chunk store: no capacity estimate, memory follows the data.
+        chunk_store_t store;
+        if (chunk_store_init(&store, 1 << hash_bits, 1, thread_count) != 0) {
+            free(tuples);
+            return -1;
+        }
+        double throughput = 0.0;
+        if (run_concurrent_chunked_timed(tuples, tuple_count, thread_count, (1 << hash_bits), &store, &throughput) != 0) {
+            fprintf(stderr, "Error in chunked concurrent run with %d threads and %d hashbits\n",
+                    thread_count, hash_bits);
+        } else {
+            printf("Threads,HashBits,Throughput\n");
+            printf("%d,%d,%.2f\n", thread_count, hash_bits, throughput);
+            fprintf(stderr, "Chunk store: %.1f MiB for %.1f MiB of tuples\n", chunk_store_bytes(&store) / 1048576.0,
+                    (double)tuple_count * sizeof(tuple_t) / 1048576.0);
+        }
+        chunk_store_free(&store);
+        free(tuples);
+        return 0;
+    }
+
     // Calculate number of partitions and effective capacity.
     int total_partitions = 1 << hash_bits;
-    int effective_capacity = (TUPLE_COUNT / total_partitions) * PARTITION_MULTIPLIER;
+    size_t effective_capacity = (tuple_count / total_partitions) * PARTITION_MULTIPLIER;
 
     // Allocate partition buffers.
     tuple_t *conc_big_block = malloc(total_partitions * effective_capacity * sizeof(tuple_t));
@@ -33,7 +107,7 @@ int main(int argc, char *argv[]) {
         return -1;
     }
     tuple_t **global_conc_buffers = malloc(total_partitions * sizeof(tuple_t *));
-    int *global_conc_indexes = calloc(total_partitions, sizeof(int));
+    size_t *global_conc_indexes = calloc(total_partitions, sizeof(size_t));
     if (!global_conc_buffers || !global_conc_indexes) {
         free(tuples);
         free(conc_big_block);
@@ -44,17 +118,53 @@ int main(int argc, char *argv[]) {
         global_conc_indexes[i] = 0;
     }
 
+    // Bloom filters (-b bits per key) are filled by the scatter itself, one fragment per thread.
+    bloom_set_t bloom = {0};
+    if (bloom_bits > 0) {
+        if (bloom_set_init(&bloom, total_partitions, thread_count, tuple_count / total_partitions, bloom_bits) != 0) {
+            fprintf(stderr, "Error allocating Bloom filters.\n");
+            free(tuples);
+            free(conc_big_block);
+            free(global_conc_buffers);
+            free(global_conc_indexes);
+            return -1;
+        }
+        opts.bloom = &bloom;
+        fprintf(stderr, "Bloom filters: %.1f MiB\n", bloom_set_bytes(&bloom) / 1048576.0);
+    }
+
+    // Per-partition statistics (-s) are collected by the scatter loops; compare the throughput
+    // with the same run without -s for their overhead.
+    partition_stats_t stats = {0};
+    if (collect_stats) {
+        if (partition_stats_init(&stats, hash_bits, thread_count, stats_default_hll_bits(hash_bits)) != 0) {
+            fprintf(stderr, "Error allocating partition statistics.\n");
+            bloom_set_free(&bloom);
+            free(tuples);
+            free(conc_big_block);
+            free(global_conc_buffers);
+            free(global_conc_indexes);
+            return -1;
+        }
+        opts.stats = &stats;
+    }
+
     // Run experiment.
     double throughput = 0.0;
-    if (run_concurrent_timed(tuples, TUPLE_COUNT, thread_count, total_partitions,
-                             global_conc_buffers, global_conc_indexes, effective_capacity, &throughput) != 0) {
+    if (run_concurrent_timed(tuples, tuple_count, thread_count, total_partitions,
+                             global_conc_buffers, global_conc_indexes, effective_capacity, &throughput,
+                             &opts) != 0) {
         fprintf(stderr, "Error in concurrent run with %d threads and %d hashbits\n", thread_count, hash_bits);
     } else {
         // Print a CSV result to STDOUT.
         printf("Threads,HashBits,Throughput\n");
         printf("%d,%d,%.2f\n", thread_count, hash_bits, throughput);
+        if (collect_stats)
+            partition_stats_print(&stats, stderr);
     }
 
+    partition_stats_free(&stats);
+    bloom_set_free(&bloom);
     free(tuples);
     free(conc_big_block);
     free(global_conc_buffers);
@@ -0,0 +1,234 @@
+#define _GNU_SOURCE
+#include "project.h"
+#include "utils.h"
+#include "affinity.h"
+#include "delegation.h"
+#include "trace.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RING_SLOTS 1024         // Tuples per ring (power of two).
+#define BATCH_SIZE 16           // Tuples staged per owner before they are pushed.
+#define DRAIN_INTERVAL 1024     // Input tuples between opportunistic drains.
+
+// Single-producer/single-consumer ring. tail is only written by the producer, head only by
+// the owner; each sits on its own cache line. The partition id travels with the tuple so
+// the owner does not hash it again.
+typedef struct {
+    unsigned long tail __attribute__((aligned(64)));
+    unsigned long head __attribute__((aligned(64)));
+    tuple_t slots[RING_SLOTS] __attribute__((aligned(64)));
+    int partitions[RING_SLOTS];
+} spsc_ring_t;
+
+typedef struct {
+    int thread_id;
+    int self;                  // 0-based owner index.
+    int thread_count;
+    tuple_t *tuples;
+    size_t tuples_index;
+    size_t tuples_length;
+    int partition_count;
+    tuple_t **partitions;
+    size_t *partition_indexes;
+    size_t capacity;
+    spsc_ring_t *rings;        // thread_count x thread_count, rings[producer * thread_count + owner].
+    int *producers_done;
+    tuple_t *staged;           // thread_count x BATCH_SIZE tuples staged per owner.
+    int *staged_partitions;
+    int *staged_counts;
+    unsigned long *cached_heads; // Producer-side copies of each outgoing ring's head.
+    struct timespec start;
+    struct timespec end;
+} thread_args_t;
+
+static inline int owner_of(int partition, int partition_count, int thread_count) {
+    return (int)(((long)partition * thread_count) / partition_count);
+}
+
+static inline void write_owned(thread_args_t *args, int partition, const tuple_t *tuple) {
+    size_t idx = args->partition_indexes[partition];
+    if (idx >= args->capacity) {
+        fprintf(stderr, "Thread %d: Partition %d overflow (idx=%zu, cap=%zu)\n",
+                args->thread_id, partition, idx, args->capacity);
+        return;
+    }
+    args->partitions[partition][idx] = *tuple;
+    args->partition_indexes[partition] = idx + 1;
+}
+
+// Moves everything queued for this owner into its partitions. Returns the number of tuples moved.
+static int drain_incoming(thread_args_t *args) {
+    int drained = 0;
+    for (int producer = 0; producer < args->thread_count; producer++) {
+        if (producer == args->self)
+            continue;
+        spsc_ring_t *ring = &args->rings[producer * args->thread_count + args->self];
+        unsigned long tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        unsigned long head = ring->head;
+        for (; head < tail; head++) {
+            unsigned long slot = head & (RING_SLOTS - 1);
+            write_owned(args, ring->partitions[slot], &ring->slots[slot]);
+            drained++;
+        }
+        __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+    }
+    return drained;
+}
+
+// Pushes the batch staged for owner, draining our own rings while the owner's ring is full
+// so that two threads waiting on each other still make progress.
+static void push_batch(thread_args_t *args, int owner) {
+    int count = args->staged_counts[owner];
+    spsc_ring_t *ring = &args->rings[args->self * args->thread_count + owner];
+    unsigned long tail = ring->tail;
+
+    while (tail - args->cached_heads[owner] + count > RING_SLOTS) {
+        args->cached_heads[owner] = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (tail - args->cached_heads[owner] + count <= RING_SLOTS)
+            break;
+        if (drain_incoming(args) == 0)
+            sched_yield();
+    }
+
+    const tuple_t *staged = args->staged + owner * BATCH_SIZE;
+    const int *staged_partitions = args->staged_partitions + owner * BATCH_SIZE;
+    for (int j = 0; j < count; j++) {
+        unsigned long slot = (tail + j) & (RING_SLOTS - 1);
+        ring->slots[slot] = staged[j];
+        ring->partitions[slot] = staged_partitions[j];
+    }
+    __atomic_store_n(&ring->tail, tail + count, __ATOMIC_RELEASE);
+    args->staged_counts[owner] = 0;
+}
+
+void *write_delegated(void *void_args) {
+    if (!void_args) return NULL;
+    thread_args_t *args = (thread_args_t *)void_args;
+
+    set_affinity(args->thread_id);
+
+    clock_gettime(CLOCK_MONOTONIC, &args->start);
+    TRACE_BEGIN("scatter");
+    for (size_t i = args->tuples_index; i < args->tuples_length; i++) {
+        int partition = hash_to_partition(args->tuples[i].key, args->partition_count);
+        int owner = owner_of(partition, args->partition_count, args->thread_count);
+        if (owner == args->self) {
+            write_owned(args, partition, &args->tuples[i]);
+        } else {
+            int n = args->staged_counts[owner]++;
+            args->staged[owner * BATCH_SIZE + n] = args->tuples[i];
+            args->staged_partitions[owner * BATCH_SIZE + n] = partition;
+            if (n + 1 == BATCH_SIZE)
+                push_batch(args, owner);
+        }
+        if ((i - args->tuples_index) % DRAIN_INTERVAL == DRAIN_INTERVAL - 1)
+            drain_incoming(args);
+    }
+
+    TRACE_END("scatter");
+
+    // Flush partial batches, announce completion, then drain until every producer is done
+    // and a drain that started after the last announcement found nothing left.
+    TRACE_BEGIN("flush");
+    for (int owner = 0; owner < args->thread_count; owner++) {
+        if (args->staged_counts[owner] > 0)
+            push_batch(args, owner);
+    }
+    __atomic_add_fetch(args->producers_done, 1, __ATOMIC_RELEASE);
+    for (;;) {
+        int done = __atomic_load_n(args->producers_done, __ATOMIC_ACQUIRE);
+        int drained = drain_incoming(args);
+        if (done == args->thread_count && drained == 0)
+            break;
+        if (drained == 0)
+            sched_yield();
+    }
+    TRACE_END("flush");
+    clock_gettime(CLOCK_MONOTONIC, &args->end);
+
+    return NULL;
+}
+
+int run_delegation_timed(tuple_t *tuples, size_t tuple_count, int thread_count, int partition_count,
+                         tuple_t **global_partition_buffers, size_t *global_partition_indexes,
+                         size_t global_capacity, double *throughput) {
+    if (!tuples) return -1;
+
+    // All of the room the buffers have (see run_independent_timed).
+    size_t effective_capacity = global_capacity;
+
+    for (int i = 0; i < partition_count; i++)
+        global_partition_indexes[i] = 0;
+
+    size_t ring_count = (size_t)thread_count * thread_count;
+    spsc_ring_t *rings = aligned_alloc(64, ring_count * sizeof(spsc_ring_t));
+    tuple_t *staged = malloc(ring_count * BATCH_SIZE * sizeof(tuple_t));
+    int *staged_partitions = malloc(ring_count * BATCH_SIZE * sizeof(int));
+    int *staged_counts = calloc(ring_count, sizeof(int));
+    unsigned long *cached_heads = calloc(ring_count, sizeof(unsigned long));
+    if (!rings || !staged || !staged_partitions || !staged_counts || !cached_heads) {
+        fprintf(stderr, "Error allocating delegation rings.\n");
+        free(rings);
+        free(staged);
+        free(staged_partitions);
+        free(staged_counts);
+        free(cached_heads);
+        return -1;
+    }
+    for (size_t r = 0; r < ring_count; r++) {
+        rings[r].head = 0;
+        rings[r].tail = 0;
+    }
+
+    pthread_t threads[thread_count];
+    thread_args_t args[thread_count];
+    int producers_done = 0;
+    size_t base_segment_size = tuple_count / thread_count;
+
+    for (int i = 0; i < thread_count; i++) {
+        size_t start_index = base_segment_size * i;
+        size_t end_index = (i == thread_count - 1) ? tuple_count : (start_index + base_segment_size);
+        args[i].thread_id = i + 1;
+        args[i].self = i;
+        args[i].thread_count = thread_count;
+        args[i].tuples = tuples;
+        args[i].tuples_index = start_index;
+        args[i].tuples_length = end_index;
+        args[i].partition_count = partition_count;
+        args[i].partitions = global_partition_buffers;
+        args[i].partition_indexes = global_partition_indexes;
+        args[i].capacity = effective_capacity;
+        args[i].rings = rings;
+        args[i].producers_done = &producers_done;
+        args[i].staged = staged + (size_t)i * thread_count * BATCH_SIZE;
+        args[i].staged_partitions = staged_partitions + (size_t)i * thread_count * BATCH_SIZE;
+        args[i].staged_counts = staged_counts + (size_t)i * thread_count;
+        args[i].cached_heads = cached_heads + (size_t)i * thread_count;
+        pthread_create(&threads[i], NULL, write_delegated, &args[i]);
+    }
+
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    long avg_time = 0;
+    for (int i = 0; i < thread_count; i++) {
+        long thread_time = (args[i].end.tv_sec - args[i].start.tv_sec) * 1000 +
+                           (args[i].end.tv_nsec - args[i].start.tv_nsec) / 1000000;
+        avg_time += thread_time;
+    }
+    avg_time /= thread_count;
+
+    *throughput = ((double)tuple_count / (avg_time / 1000.0)) / 1e6;
+
+    free(rings);
+    free(staged);
+    free(staged_partitions);
+    free(staged_counts);
+    free(cached_heads);
+    return 0;
+}
@@ -0,0 +1,14 @@
+#ifndef DELEGATION_H
+#define DELEGATION_H
+
+#include "project.h"
+
+// Delegation strategy: thread i owns a contiguous range of partitions and is the only thread
+// that writes them. Every thread hashes its slice of the input and hands tuples for other
+// owners over in small batches through single-producer/single-consumer rings, which the
+// owners drain into their partitions. Output layout matches run_concurrent_timed.
+int run_delegation_timed(tuple_t *tuples, size_t tuple_count, int thread_count, int partition_count,
+                         tuple_t **global_partition_buffers, size_t *global_partition_indexes,
+                         size_t global_capacity, double *throughput);
+
+#endif
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "delegation.h"
+#include "project.h"
+#include "utils.h"
+#include "tuples.h"
+
+#define DEFAULT_TUPLE_COUNT ((size_t)1 << 24)  // ~16 million tuples; -n overrides it
+
+int main(int argc, char *argv[]) {
+    const char *usage = "Usage: %s [-n LOG2_TUPLES] <THREAD_COUNT> <HASHBITS>\n";
+    size_t tuple_count = DEFAULT_TUPLE_COUNT;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        switch (opt) {
+        case 'n':
+            if (parse_log2_tuples(optarg, &tuple_count) != 0) {
+                fprintf(stderr, "Invalid LOG2_TUPLES '%s'.\n", optarg);
+                return -1;
+            }
+            break;
+        default:
+            fprintf(stderr, usage, argv[0]);
+            return -1;
+        }
+    }
+    if (argc - optind < 2) {
+        fprintf(stderr, usage, argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[optind]);
+    int hash_bits = atoi(argv[optind + 1]);
+
+    // Generate tuples.
+    tuple_t *tuples = generate_tuples(tuple_count);
+    if (!tuples) {
+        fprintf(stderr, "Error generating tuples.\n");
+        return -1;
+    }
+
+    // Calculate number of partitions and effective capacity.
+    int total_partitions = 1 << hash_bits;
+    size_t effective_capacity = (tuple_count / total_partitions) * PARTITION_MULTIPLIER;
+
+    // Allocate partition buffers.
+    tuple_t *deleg_big_block = malloc(total_partitions * effective_capacity * sizeof(tuple_t));
+    if (!deleg_big_block) {
+        free(tuples);
+        return -1;
+    }
+    tuple_t **global_deleg_buffers = malloc(total_partitions * sizeof(tuple_t *));
+    size_t *global_deleg_indexes = calloc(total_partitions, sizeof(size_t));
+    if (!global_deleg_buffers || !global_deleg_indexes) {
+        free(tuples);
+        free(deleg_big_block);
+        return -1;
+    }
+    for (int i = 0; i < total_partitions; i++) {
+        global_deleg_buffers[i] = deleg_big_block + i * effective_capacity;
+        global_deleg_indexes[i] = 0;
+    }
+
+    // Run experiment.
+    double throughput = 0.0;
+    if (run_delegation_timed(tuples, tuple_count, thread_count, total_partitions,
+                             global_deleg_buffers, global_deleg_indexes, effective_capacity, &throughput) != 0) {
+        fprintf(stderr, "Error in delegation run with %d threads and %d hashbits\n", thread_count, hash_bits);
+    } else {
+        // Print a CSV result to STDOUT.
+        printf("Threads,HashBits,Throughput\n");
+        printf("%d,%d,%.2f\n", thread_count, hash_bits, throughput);
+    }
+
+    free(tuples);
+    free(deleg_big_block);
+    free(global_deleg_buffers);
+    free(global_deleg_indexes);
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "fanout.h"
+#include "trace.h"
+#include <stdint.h>
+#include <string.h>
+
+// hash_key with the length fixed at 8 bytes, so that it inlines into the kernels. Gives the
+// same hash, hence the same partitions, as the generic kernels.
+static inline uint32_t hash_key8(const unsigned char *key) {
+    const uint32_t c1 = 0xcc9e2d51;
+    const uint32_t c2 = 0x1b873593;
+    uint32_t h1 = 42;
+    for (int i = 0; i < 2; i++) {
+        uint32_t k1;
+        memcpy(&k1, key + 4 * i, sizeof(k1));
+        k1 *= c1;
+        k1 = (k1 << 15) | (k1 >> 17);
+        k1 *= c2;
+        h1 ^= k1;
+        h1 = (h1 << 13) | (h1 >> 19);
+        h1 = h1 * 5 + 0xe6546b64;
+    }
+    h1 ^= 8;
+    h1 ^= h1 >> 16;
+    h1 *= 0x85ebca6b;
+    h1 ^= h1 >> 13;
+    h1 *= 0xc2b2ae35;
+    h1 ^= h1 >> 16;
+    return h1;
+}
+
+// Kernel templates: every instantiation below passes a constant bits, which the compiler folds
+// into the mask and into the choice between stack and caller counters.
+static inline __attribute__((always_inline)) size_t scatter_independent_fixed(int bits, const tuple_t *tuples,
+                                                                                size_t begin, size_t end,
+                                                                                tuple_t **buffers, size_t *sizes,
+                                                                                size_t capacity) {
+    const uint32_t partition_count = 1u << bits;
+    size_t local[FANOUT_LOCAL_COUNTERS];
+    size_t *counts = partition_count <= FANOUT_LOCAL_COUNTERS ? local : sizes;
+    if (counts == local)
+        memcpy(local, sizes, partition_count * sizeof(size_t));
+
+    size_t dropped = 0;
+    for (size_t i = begin; i < end; i++) {
+        uint32_t p = hash_key8(tuples[i].key) & (partition_count - 1);
+        size_t idx = counts[p];
+        if (idx >= capacity) {
+            dropped++;
+            continue;
+        }
+        buffers[p][idx] = tuples[i];
+        counts[p] = idx + 1;
+    }
+
+    if (counts == local)
+        memcpy(sizes, local, partition_count * sizeof(size_t));
+    return dropped;
+}
+
+static inline __attribute__((always_inline)) size_t scatter_concurrent_fixed(int bits, const tuple_t *tuples,
+                                                                               size_t begin, size_t end,
+                                                                               tuple_t **buffers, size_t *indexes,
+                                                                               pthread_mutex_t *mutexes,
+                                                                               size_t capacity) {
+    const uint32_t partition_count = 1u << bits;
+    size_t dropped = 0;
+    for (size_t i = begin; i < end; i++) {
+        uint32_t p = hash_key8(tuples[i].key) & (partition_count - 1);
+        TRACE_LOCK(&mutexes[p]);
+        size_t idx = indexes[p];
+        if (idx < capacity)
+            indexes[p] = idx + 1;
+        pthread_mutex_unlock(&mutexes[p]);
+        if (idx >= capacity) {
+            dropped++;
+            continue;
+        }
+        buffers[p][idx] = tuples[i];
+    }
+    return dropped;
+}
+
+#define FANOUT_INSTANCE(bits)                                                                                    \
+    static size_t scatter_independent_##bits(const tuple_t *tuples, size_t begin, size_t end, tuple_t **buffers, \
+                                             size_t *sizes, size_t capacity) {                                   \
+        return scatter_independent_fixed(bits, tuples, begin, end, buffers, sizes, capacity);                   \
+    }                                                                                                            \
+    static size_t scatter_concurrent_##bits(const tuple_t *tuples, size_t begin, size_t end, tuple_t **buffers,  \
+                                            size_t *indexes, pthread_mutex_t *mutexes, size_t capacity) {        \
+        return scatter_concurrent_fixed(bits, tuples, begin, end, buffers, indexes, mutexes, capacity);         \
+    }
+
+#define FANOUT_ENTRY(bits) {scatter_independent_##bits, scatter_concurrent_##bits},
+
+// Every compiled fan-out, FANOUT_MIN_BITS .. FANOUT_MAX_BITS.
+#define FANOUT_LIST(X) \
+    X(1) X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9) X(10) X(11) X(12) X(13) X(14) X(15) X(16) X(17) X(18)
+
+FANOUT_LIST(FANOUT_INSTANCE)
+
+static const fanout_kernels_t fanout_table[] = {FANOUT_LIST(FANOUT_ENTRY)};
+
+const fanout_kernels_t *fanout_kernels(int hash_bits) {
+    if (hash_bits < FANOUT_MIN_BITS || hash_bits > FANOUT_MAX_BITS)
+        return NULL;
+    return &fanout_table[hash_bits - FANOUT_MIN_BITS];
+}
@@ -0,0 +1,34 @@
+#ifndef FANOUT_H
+#define FANOUT_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include "project.h"
+
+// Scatter kernels compiled once per fan-out 2^FANOUT_MIN_BITS .. 2^FANOUT_MAX_BITS. With the
+// fan-out a constant, the partition id is a mask of an inlined hash instead of a division, and
+// up to FANOUT_LOCAL_COUNTERS partition counters live on the stack, where the compiler can keep
+// them apart from the tuple stores. They cover the plain loops only; prefetching, Bloom filters,
+// statistics and range partitioning use the generic kernels.
+#define FANOUT_MIN_BITS 1
+#define FANOUT_MAX_BITS 18
+#define FANOUT_LOCAL_COUNTERS 2048
+
+// Independent path: scatters tuples [begin, end) into private buffers. Returns the number of
+// tuples dropped because their buffer was full.
+typedef size_t (*fanout_independent_fn)(const tuple_t *tuples, size_t begin, size_t end, tuple_t **buffers,
+                                        size_t *sizes, size_t capacity);
+
+// Concurrent path: shared buffers whose indexes are reserved under the partition mutexes.
+typedef size_t (*fanout_concurrent_fn)(const tuple_t *tuples, size_t begin, size_t end, tuple_t **buffers,
+                                       size_t *indexes, pthread_mutex_t *mutexes, size_t capacity);
+
+typedef struct {
+    fanout_independent_fn independent;
+    fanout_concurrent_fn concurrent;
+} fanout_kernels_t;
+
+// Kernels for 2^hash_bits partitions, or NULL when hash_bits is outside the compiled range.
+const fanout_kernels_t *fanout_kernels(int hash_bits);
+
+#endif
@@ -0,0 +1,114 @@
+#define _GNU_SOURCE
+#include "project.h"
+#include "utils.h"
+#include "tasks.h"
+#include "partitions.h"
+#include "hybrid.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define MERGE_TASKS_PER_THREAD 8
+
+typedef struct {
+    const partition_set_t *fragments;
+    tuple_t **partitions;
+    size_t *partition_indexes;
+    size_t capacity;
+    int partitions_per_task;
+} merge_ctx_t;
+
+// Copies count tuples with non-temporal stores, so the merged output does not evict the
+// fragments still being read. Falls back to memcpy without SSE2 or for unaligned targets.
+static void stream_copy(tuple_t *dst, const tuple_t *src, size_t count) {
+#ifdef __SSE2__
+    if (((uintptr_t)dst & 15) == 0) {
+        for (size_t i = 0; i < count; i++)
+            _mm_stream_si128((__m128i *)&dst[i], _mm_loadu_si128((const __m128i *)&src[i]));
+        return;
+    }
+#endif
+    memcpy(dst, src, count * sizeof(tuple_t));
+}
+
+static void merge_partitions(int task, int worker_id, void *void_ctx) {
+    (void)worker_id;
+    merge_ctx_t *ctx = (merge_ctx_t *)void_ctx;
+    const partition_set_t *set = ctx->fragments;
+    int first = task * ctx->partitions_per_task;
+    int last = first + ctx->partitions_per_task;
+    if (last > set->partition_count)
+        last = set->partition_count;
+
+    TRACE_BEGIN("merge");
+    for (int p = first; p < last; p++) {
+        size_t idx = 0;
+        for (int f = 0; f < set->fragment_count; f++) {
+            int slot = f * set->partition_count + p;
+            size_t count = set->sizes[slot];
+            if (idx + count > ctx->capacity) {
+                fprintf(stderr, "Merge: Partition %d overflow (idx=%zu, cap=%zu)\n", p, idx + count, ctx->capacity);
+                count = ctx->capacity - idx;
+            }
+            stream_copy(ctx->partitions[p] + idx, set->buffers[slot], count);
+            idx += count;
+        }
+        ctx->partition_indexes[p] = idx;
+    }
+#ifdef __SSE2__
+    _mm_sfence();
+#endif
+    TRACE_END("merge");
+}
+
+int run_hybrid_timed(tuple_t *tuples, size_t tuple_count, int thread_count, int partition_count,
+                     tuple_t **global_partition_buffers, size_t *global_partition_indexes,
+                     size_t global_capacity, double *throughput, double *scatter_ms, double *merge_ms) {
+    if (!tuples) return -1;
+
+    int hash_bits = 0;
+    while ((1 << hash_bits) < partition_count)
+        hash_bits++;
+
+    size_t effective_capacity = (tuple_count / partition_count) * PARTITION_MULTIPLIER;
+    if (effective_capacity > global_capacity)
+        effective_capacity = global_capacity;
+
+    partition_set_t fragments;
+    if (partition_set_init(&fragments, STRATEGY_INDEPENDENT, tuple_count, thread_count, hash_bits) != 0)
+        return -1;
+
+    struct timespec start, scattered, end;
+    double kernel_throughput;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    if (run_strategy_timed(&fragments, tuples, tuple_count, thread_count, &kernel_throughput, NULL) != 0) {
+        partition_set_free(&fragments);
+        return -1;
+    }
+    clock_gettime(CLOCK_MONOTONIC_RAW, &scattered);
+
+    // Contiguous partition ranges per task, several tasks per thread to even out skew.
+    int task_count = thread_count * MERGE_TASKS_PER_THREAD;
+    if (task_count > partition_count)
+        task_count = partition_count;
+    merge_ctx_t ctx = {
+        .fragments = &fragments,
+        .partitions = global_partition_buffers,
+        .partition_indexes = global_partition_indexes,
+        .capacity = effective_capacity,
+        .partitions_per_task = (partition_count + task_count - 1) / task_count,
+    };
+    int ret = run_tasks(thread_count, task_count, merge_partitions, &ctx);
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+
+    *scatter_ms = elapsed_ms(&start, &scattered);
+    *merge_ms = elapsed_ms(&scattered, &end);
+    *throughput = ((double)tuple_count / (elapsed_ms(&start, &end) / 1000.0)) / 1e6;
+
+    partition_set_free(&fragments);
+    return ret;
+}
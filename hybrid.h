@@ -0,0 +1,14 @@
+#ifndef HYBRID_H
+#define HYBRID_H
+
+#include "project.h"
+
+// Hybrid strategy: runs the independent kernel into thread-private fragments, then merges the
+// fragments of every partition into one contiguous shared partition in parallel. The output has
+// the same shape as run_concurrent_timed. scatter_ms and merge_ms report the wall time of the
+// two phases; throughput covers both.
+int run_hybrid_timed(tuple_t *tuples, size_t tuple_count, int thread_count, int partition_count,
+                     tuple_t **global_partition_buffers, size_t *global_partition_indexes,
+                     size_t global_capacity, double *throughput, double *scatter_ms, double *merge_ms);
+
+#endif
@@ -4,6 +4,12 @@
 #include "affinity.h"
 #include "independent.h"
 #include "tuples.h"  // For tuple_t definition
+#include "chunk_store.h"
+#include "fanout.h"
+#include "predicate.h"
+#include "scatter.h"
+#include "stats.h"
+#include "trace.h"
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -13,17 +19,66 @@
 typedef struct {
     int thread_id;
     tuple_t *tuples;
-    int tuples_index;       // Start index (inclusive)
-    int tuples_length;      // End index (exclusive)
+    size_t tuples_index;    // Start index (inclusive)
+    size_t tuples_length;   // End index (exclusive)
     int partition_count;    // Number of partitions (1 << hash_bits)
     tuple_t **partition_buffers; // This thread's slice of the global partition buffers.
-    int *partition_sizes;   // This thread's slice of the global partition sizes.
-    int estimated_per_partition; // Maximum estimated capacity per partition.
+    size_t *partition_sizes; // This thread's slice of the global partition sizes.
+    size_t estimated_per_partition; // Maximum estimated capacity per partition.
+    int prefetch_distance;         // Software-pipelined scatter when > 0.
+    fanout_independent_fn kernel;  // Kernel compiled for this fan-out, or NULL for the generic loop.
+    chunk_list_t *partition_lists; // This thread's slice of the chunk store (chunked mode).
+    chunk_pool_t *pool;            // This thread's chunk pool (chunked mode).
+    const partition_opts_t *opts;  // Bloom filters and statistics to fill while scattering, or NULL.
     // Per-thread timing (recorded just before and after processing tuples).
     struct timespec start;
     struct timespec end;
 } thread_args_t;
 
+// Scatters tuples [begin, end) with the kernel picked for this run: the prefetching pipeline, the
+// kernel compiled for this fan-out, or the generic loop.
+static void scatter_tuples(thread_args_t *args, const tuple_t *tuples, size_t begin, size_t end) {
+    if (args->prefetch_distance > 0) {
+        scatter_independent_prefetch(tuples, begin, end, args->partition_count, args->partition_buffers,
+                                     args->partition_sizes, args->estimated_per_partition, args->prefetch_distance,
+                                     args->thread_id, args->opts);
+        return;
+    }
+
+    if (args->kernel) {
+        size_t dropped = args->kernel(tuples, begin, end, args->partition_buffers, args->partition_sizes,
+                                      args->estimated_per_partition);
+        if (dropped)
+            fprintf(stderr, "Thread %d: %zu tuples dropped on partition overflow (cap=%zu)\n", args->thread_id,
+                    dropped, args->estimated_per_partition);
+        return;
+    }
+
+    partition_stats_t *stats = args->opts ? args->opts->stats : NULL;
+    stats_fragment_t stats_view = stats ? partition_stats_fragment(stats, args->thread_id - 1) : (stats_fragment_t){0};
+    const range_splitters_t *range = args->opts ? args->opts->range : NULL;
+
+    // Process tuples in the half-open range [begin, end)
+    for (size_t i = begin; i < end; i++) {
+        uint32_t hash;
+        int partition_id = scatter_partition(range, stats != NULL, tuples[i].key, args->partition_count, &hash);
+        size_t idx = args->partition_sizes[partition_id];
+        if (idx >= args->estimated_per_partition) {
+            fprintf(stderr, "Thread %d: Partition %d overflow (idx=%zu, cap=%zu)\n",
+                    args->thread_id, partition_id, idx, args->estimated_per_partition);
+            continue;
+        }
+        args->partition_buffers[partition_id][idx] = tuples[i];
+        args->partition_sizes[partition_id]++;
+        if (stats)
+            stats_fragment_add(stats_view, partition_id, hash, tuples[i].key);
+    }
+}
+
+static void scatter_selected(void *ctx, const tuple_t *tuples, size_t count) {
+    scatter_tuples((thread_args_t *)ctx, tuples, 0, count);
+}
+
 // Thread function that processes a slice of tuples and records per-thread timing.
 void *write_independent_output(void *void_args) {
     if (!void_args)
@@ -33,82 +88,68 @@ void *write_independent_output(void *void_args) {
     // Set thread affinity for this thread.
     set_affinity(args->thread_id);
 
+    // Checked before the trace span opens. A thread that bails out still joins the Bloom filter
+    // and statistics merge, whose barrier waits for every thread.
+    if (!args->tuples || !args->partition_buffers) {
+        scatter_opts_finish(args->opts, args->thread_id - 1);
+        return NULL;
+    }
+
     // Record the start time immediately before processing.
     clock_gettime(CLOCK_MONOTONIC_RAW, &args->start);
+    TRACE_BEGIN("scatter");
 
-    if (!args->tuples || !args->partition_buffers)
-        return NULL;
-
-    // Process tuples in the half-open range [tuples_index, tuples_length)
-    for (int i = args->tuples_index; i < args->tuples_length; i++) {
-        int partition_id = hash_to_partition(args->tuples[i].key, args->partition_count);
-        int idx = args->partition_sizes[partition_id];
-        if (idx >= args->estimated_per_partition) {
-            fprintf(stderr, "Thread %d: Partition %d overflow (idx=%d, cap=%d)\n",
-                    args->thread_id, partition_id, idx, args->estimated_per_partition);
-            continue;
-        }
-        args->partition_buffers[partition_id][idx] = args->tuples[i];
-        args->partition_sizes[partition_id]++;
+    const scan_predicate_t *predicate = args->opts ? args->opts->predicate : NULL;
+    if (predicate) {
+        // Qualifying tuples are compacted into a cache-resident batch and scattered from there,
+        // so the filtered input never goes back to memory.
+        predicate_scan(predicate, args->tuples, args->tuples_index, args->tuples_length, scatter_selected, args);
+    } else {
+        scatter_tuples(args, args->tuples, args->tuples_index, args->tuples_length);
     }
+    TRACE_END("scatter");
+    scatter_opts_finish(args->opts, args->thread_id - 1);
     // Record the end time immediately after finishing processing.
     clock_gettime(CLOCK_MONOTONIC_RAW, &args->end);
     return NULL;
 }
 
-// Runs the partitioning using pthreads.
-// After joining, each thread’s processing time (in ms) is computed and averaged.
-// The throughput is computed as follows:
-//      throughput = ((double)tuple_count / (avg_time_in_seconds)) / 1e6
-int run_independent_timed(tuple_t *tuples, int tuple_count, int thread_count, int hash_bits,
-                          tuple_t **global_partition_buffers, int *global_partition_sizes,
-                          int global_capacity, double *throughput) {
-    if (!tuples)
-        return -1;
-    
-    int partition_count = 1 << hash_bits;
-    int effective_capacity = (tuple_count / partition_count) * PARTITION_MULTIPLIER;
-    if (effective_capacity > global_capacity)
-        effective_capacity = global_capacity;
-    int total_threads = thread_count;
-    int base_segment_size = tuple_count / total_threads;  // using half-open intervals
+// Chunked variant: partitions grow on demand, so no tuple is dropped.
+void *write_independent_chunked(void *void_args) {
+    if (!void_args)
+        return NULL;
+    thread_args_t *args = (thread_args_t *)void_args;
 
-    // Reset the global partition sizes.
-    int used_partitions = total_threads * partition_count;
-    for (int i = 0; i < used_partitions; i++) {
-        global_partition_sizes[i] = 0;
+    set_affinity(args->thread_id);
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &args->start);
+    TRACE_BEGIN("scatter");
+    for (size_t i = args->tuples_index; i < args->tuples_length; i++) {
+        int partition_id = hash_to_partition(args->tuples[i].key, args->partition_count);
+        chunk_list_append(&args->partition_lists[partition_id], args->pool, &args->tuples[i]);
     }
+    TRACE_END("scatter");
+    clock_gettime(CLOCK_MONOTONIC_RAW, &args->end);
+    return NULL;
+}
 
-    // Allocate arrays for thread structures and their arguments.
-    thread_args_t *args = malloc(total_threads * sizeof(thread_args_t));
+// Starts one thread per args entry running fn, joins them, and computes the throughput
+// from the average per-thread processing time.
+static int run_partition_threads(thread_args_t *args, int total_threads, void *(*fn)(void *), size_t tuple_count,
+                                 double *throughput) {
     pthread_t *threads = malloc(total_threads * sizeof(pthread_t));
-    if (!args || !threads) {
+    if (!threads) {
         fprintf(stderr, "Error allocating memory for thread structures.\n");
-        free(args);
-        free(threads);
         return -1;
     }
 
     // Create threads.
     for (int i = 0; i < total_threads; i++) {
-        int start_index = base_segment_size * i;
-        int end_index = (i == total_threads - 1) ? tuple_count : (start_index + base_segment_size);
-        args[i].thread_id = i + 1;
-        args[i].tuples = tuples;
-        args[i].tuples_index = start_index;
-        args[i].tuples_length = end_index;
-        args[i].partition_count = partition_count;
-        args[i].estimated_per_partition = effective_capacity;
-        // Each thread gets its slice of the global buffers.
-        args[i].partition_buffers = global_partition_buffers + (i * partition_count);
-        args[i].partition_sizes = global_partition_sizes + (i * partition_count);
-
-        if (pthread_create(&threads[i], NULL, write_independent_output, &args[i]) != 0) {
+        if (pthread_create(&threads[i], NULL, fn, &args[i]) != 0) {
             fprintf(stderr, "Error creating thread %d\n", i);
             for (int j = 0; j < i; j++) {
                 pthread_join(threads[j], NULL);
             }
-            free(args);
             free(threads);
             return -1;
         }
@@ -130,7 +171,111 @@ int run_independent_timed(tuple_t *tuples, int tuple_count, int thread_count, in
 
     *throughput = ((double)tuple_count / avg_time_sec) / 1e6;  // Throughput in millions of tuples/sec
 
-    free(args);
     free(threads);
     return 0;
 }
+
+// Fills the per-thread arguments shared by the fixed and chunked variants.
+static void init_thread_args(thread_args_t *args, int total_threads, tuple_t *tuples, size_t tuple_count,
+                             int partition_count) {
+    size_t base_segment_size = tuple_count / total_threads;  // using half-open intervals
+    for (int i = 0; i < total_threads; i++) {
+        size_t start_index = base_segment_size * i;
+        size_t end_index = (i == total_threads - 1) ? tuple_count : (start_index + base_segment_size);
+        args[i].thread_id = i + 1;
+        args[i].tuples = tuples;
+        args[i].tuples_index = start_index;
+        args[i].tuples_length = end_index;
+        args[i].partition_count = partition_count;
+        args[i].partition_buffers = NULL;
+        args[i].partition_sizes = NULL;
+        args[i].estimated_per_partition = 0;
+        args[i].prefetch_distance = 0;
+        args[i].kernel = NULL;
+        args[i].partition_lists = NULL;
+        args[i].pool = NULL;
+        args[i].opts = NULL;
+    }
+}
+
+// Runs the partitioning using pthreads.
+// After joining, each thread’s processing time (in ms) is computed and averaged.
+// The throughput is computed as follows:
+//      throughput = ((double)tuple_count / (avg_time_in_seconds)) / 1e6
+int run_independent_timed(tuple_t *tuples, size_t tuple_count, int thread_count, int hash_bits,
+                          tuple_t **global_partition_buffers, size_t *global_partition_sizes,
+                          size_t global_capacity, double *throughput, const partition_opts_t *opts) {
+    if (!tuples)
+        return -1;
+    
+    int partition_count = 1 << hash_bits;
+    // All of the room the buffers have: an estimate from tuple_count would be too small for inputs
+    // much smaller than the buffers were sized for, such as pre-filtered ones.
+    size_t effective_capacity = global_capacity;
+    int total_threads = thread_count;
+
+    // Reset the global partition sizes.
+    size_t used_partitions = (size_t)total_threads * partition_count;
+    for (size_t i = 0; i < used_partitions; i++) {
+        global_partition_sizes[i] = 0;
+    }
+
+    // Allocate the thread arguments.
+    thread_args_t *args = malloc(total_threads * sizeof(thread_args_t));
+    if (!args) {
+        fprintf(stderr, "Error allocating memory for thread structures.\n");
+        return -1;
+    }
+
+    if (scatter_opts_prepare(opts, partition_count, total_threads) != 0) {
+        free(args);
+        return -1;
+    }
+
+    int prefetch_distance = resolve_prefetch_distance(opts, tuples, tuple_count, partition_count);
+    const fanout_kernels_t *kernels = scatter_fanout_kernels(opts, prefetch_distance, partition_count);
+    init_thread_args(args, total_threads, tuples, tuple_count, partition_count);
+    for (int i = 0; i < total_threads; i++) {
+        args[i].estimated_per_partition = effective_capacity;
+        args[i].prefetch_distance = prefetch_distance;
+        args[i].kernel = kernels ? kernels->independent : NULL;
+        args[i].opts = opts;
+        // Each thread gets its slice of the global buffers.
+        args[i].partition_buffers = global_partition_buffers + ((size_t)i * partition_count);
+        args[i].partition_sizes = global_partition_sizes + ((size_t)i * partition_count);
+    }
+
+    int ret = run_partition_threads(args, total_threads, write_independent_output, tuple_count, throughput);
+    free(args);
+    return ret;
+}
+
+// Chunked variant of run_independent_timed. store must have one fragment and one pool per thread;
+// it is reset before partitioning.
+int run_independent_chunked_timed(tuple_t *tuples, size_t tuple_count, int thread_count, int hash_bits,
+                                  chunk_store_t *store, double *throughput) {
+    if (!tuples || !store)
+        return -1;
+
+    int partition_count = 1 << hash_bits;
+    if (store->partition_count != partition_count || store->fragment_count != thread_count ||
+        store->pool_count != thread_count)
+        return -1;
+    chunk_store_reset(store);
+
+    thread_args_t *args = malloc(thread_count * sizeof(thread_args_t));
+    if (!args) {
+        fprintf(stderr, "Error allocating memory for thread structures.\n");
+        return -1;
+    }
+
+    init_thread_args(args, thread_count, tuples, tuple_count, partition_count);
+    for (int i = 0; i < thread_count; i++) {
+        args[i].partition_lists = store->lists + ((size_t)i * partition_count);
+        args[i].pool = &store->pools[i];
+    }
+
+    int ret = run_partition_threads(args, thread_count, write_independent_chunked, tuple_count, throughput);
+    free(args);
+    return ret;
+}
@@ -2,9 +2,15 @@
 #define INDEPENDENT_H
 
 #include "project.h"
+#include "chunk_store.h"
 
-int run_independent_timed(tuple_t *tuples, int tuple_count, int thread_count, int hash_bits,
-                          tuple_t **global_partition_buffers, int *global_partition_sizes,
-                          int global_capacity, double *throughput);
+int run_independent_timed(tuple_t *tuples, size_t tuple_count, int thread_count, int hash_bits,
+                          tuple_t **global_partition_buffers, size_t *global_partition_sizes,
+                          size_t global_capacity, double *throughput, const partition_opts_t *opts);
+
+// Same partitioning into a growable chunk store (one fragment and one chunk pool per thread)
+// instead of fixed-capacity buffers, so skewed partitions never drop tuples.
+int run_independent_chunked_timed(tuple_t *tuples, size_t tuple_count, int thread_count, int hash_bits,
+                                  chunk_store_t *store, double *throughput);
 
 #endif
@@ -1,40 +1,116 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "independent.h"
 #include "project.h"
 #include "utils.h"
+#include "scatter.h"
+#include "bloom.h"
+#include "stats.h"
 #include "tuples.h"  // For generate_tuples
 
-#define TUPLE_COUNT (1 << 24)  // ~16 million tuples
+#define DEFAULT_TUPLE_COUNT ((size_t)1 << 24)  // ~16 million tuples; -n overrides it
 
 int main(int argc, char *argv[]) {
-    if (argc < 3) {
-        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS>\n", argv[0]);
+    const char *usage =
+        "Usage: %s [-n LOG2_TUPLES] [-p PREFETCH_DISTANCE|auto] [-b BLOOM_BITS] [-s] [-k] <THREAD_COUNT> "
+        "<HASHBITS> [fixed|chunked]\n";
+    partition_opts_t opts = {0};
+    size_t tuple_count = DEFAULT_TUPLE_COUNT;
+    int bloom_bits = 0;
+    int collect_stats = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:p:b:sk")) != -1) {
+        switch (opt) {
+        case 'n':
+            if (parse_log2_tuples(optarg, &tuple_count) != 0) {
+                fprintf(stderr, "Invalid LOG2_TUPLES '%s'.\n", optarg);
+                return -1;
+            }
+            break;
+        case 'p':
+            opts.prefetch_distance = strcmp(optarg, "auto") == 0 ? -1 : atoi(optarg);
+            break;
+        case 'b':
+            bloom_bits = atoi(optarg);
+            break;
+        case 's':
+            collect_stats = 1;
+            break;
+        case 'k':
+            opts.specialized = 1;
+            break;
+        default:
+            fprintf(stderr, usage, argv[0]);
+            return -1;
+        }
+    }
+    if (argc - optind < 2) {
+        fprintf(stderr, usage, argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[optind]);
+    int hash_bits = atoi(argv[optind + 1]);
+    int chunked = argc - optind > 2 && strcmp(argv[optind + 2], "chunked") == 0;
+    // The chunk store has its own append loop, without prefetching, Bloom filters, statistics or
+    // specialized kernels, so those options would be silently dropped.
+    if (chunked && (opts.prefetch_distance || bloom_bits || collect_stats || opts.specialized)) {
+        fprintf(stderr, "-p, -b, -s and -k are not supported in chunked mode.\n");
+        fprintf(stderr, usage, argv[0]);
         return -1;
     }
-    int thread_count = atoi(argv[1]);
-    int hash_bits = atoi(argv[2]);
 
     // Generate tuples.
-    tuple_t *tuples = generate_tuples(TUPLE_COUNT);
+    tuple_t *tuples = generate_tuples(tuple_count);
     if (!tuples) {
         fprintf(stderr, "Error generating tuples.\n");
         return -1;
     }
 
+    // Tune the prefetch distance once, outside the timed run, and report the choice.
+    if (opts.prefetch_distance < 0) {
+        opts.prefetch_distance = tune_prefetch_distance(tuples, tuple_count, 1 << hash_bits);
+        fprintf(stderr, "Tuned prefetch distance: %d\n", opts.prefetch_distance);
+    }
+
+    if (chunked) {
+        // Growable chunk store: no capacity estimate, memory follows the data.
+        chunk_store_t store;
+        if (chunk_store_init(&store, 1 << hash_bits, thread_count, thread_count) != 0) {
+            free(tuples);
+            return -1;
+        }
+        double throughput = 0.0;
+        if (run_independent_chunked_timed(tuples, tuple_count, thread_count, hash_bits, &store,
+                                          &throughput) != 0) {
+            fprintf(stderr, "Error in chunked independent run with %d threads and %d hashbits\n",
+                    thread_count, hash_bits);
+        } else {
+            printf("Threads,HashBits,Throughput\n");
+            printf("%d,%d,%.2f\n", thread_count, hash_bits, throughput);
+            fprintf(stderr, "Chunk store: %.1f MiB for %.1f MiB of tuples\n", chunk_store_bytes(&store) / 1048576.0,
+                    (double)tuple_count * sizeof(tuple_t) / 1048576.0);
+        }
+        chunk_store_free(&store);
+        free(tuples);
+        return 0;
+    }
+
     // Calculate per-thread parameters.
     int partitions_per_thread = 1 << hash_bits;
     int total_partitions = thread_count * partitions_per_thread;
-    int effective_capacity = (TUPLE_COUNT / partitions_per_thread) * PARTITION_MULTIPLIER;
+    size_t effective_capacity = (tuple_count / partitions_per_thread) * PARTITION_MULTIPLIER;
+    size_t thread_capacity = tuple_count * PARTITION_MULTIPLIER;
 
     // Allocate global buffers.
-    tuple_t *indep_big_block = malloc(thread_count * TUPLE_COUNT * PARTITION_MULTIPLIER * sizeof(tuple_t));
+    tuple_t *indep_big_block = malloc(thread_count * thread_capacity * sizeof(tuple_t));
     if (!indep_big_block) {
         free(tuples);
         return -1;
     }
     tuple_t **global_indep_buffers = malloc(total_partitions * sizeof(tuple_t *));
-    int *global_indep_indexes = calloc(total_partitions, sizeof(int));
+    size_t *global_indep_indexes = calloc(total_partitions, sizeof(size_t));
     if (!global_indep_buffers || !global_indep_indexes) {
         free(tuples);
         free(indep_big_block);
@@ -44,24 +120,62 @@ int main(int argc, char *argv[]) {
         for (int part = 0; part < partitions_per_thread; part++) {
             int idx = thr * partitions_per_thread + part;
             global_indep_buffers[idx] = indep_big_block +
-                thr * (TUPLE_COUNT * PARTITION_MULTIPLIER) +
+                thr * thread_capacity +
                 part * effective_capacity;
             global_indep_indexes[idx] = 0;
         }
     }
 
+    // Bloom filters (-b bits per key) are filled by the scatter itself; their cost shows up as
+    // lower throughput than the same run without -b.
+    bloom_set_t bloom = {0};
+    if (bloom_bits > 0) {
+        if (bloom_set_init(&bloom, partitions_per_thread, thread_count, tuple_count / partitions_per_thread,
+                           bloom_bits) != 0) {
+            fprintf(stderr, "Error allocating Bloom filters.\n");
+            free(tuples);
+            free(indep_big_block);
+            free(global_indep_buffers);
+            free(global_indep_indexes);
+            return -1;
+        }
+        opts.bloom = &bloom;
+        fprintf(stderr, "Bloom filters: %.1f MiB\n", bloom_set_bytes(&bloom) / 1048576.0);
+    }
+
+    // Per-partition statistics (-s) are collected by the scatter loops; compare the throughput
+    // with the same run without -s for their overhead.
+    partition_stats_t stats = {0};
+    if (collect_stats) {
+        if (partition_stats_init(&stats, hash_bits, thread_count, stats_default_hll_bits(hash_bits)) != 0) {
+            fprintf(stderr, "Error allocating partition statistics.\n");
+            bloom_set_free(&bloom);
+            free(tuples);
+            free(indep_big_block);
+            free(global_indep_buffers);
+            free(global_indep_indexes);
+            return -1;
+        }
+        opts.stats = &stats;
+    }
+
     // Run experiment.
     double throughput = 0.0;
-    if (run_independent_timed(tuples, TUPLE_COUNT, thread_count, hash_bits,
-                              global_indep_buffers, global_indep_indexes, effective_capacity, &throughput) != 0) {
+    if (run_independent_timed(tuples, tuple_count, thread_count, hash_bits,
+                              global_indep_buffers, global_indep_indexes, effective_capacity, &throughput,
+                              &opts) != 0) {
         fprintf(stderr, "Error in independent run with %d threads and %d hashbits\n", thread_count, hash_bits);
     } else {
         // Print a CSV result to STDOUT.
         printf("Threads,HashBits,Throughput\n");
         printf("%d,%d,%.2f\n", thread_count, hash_bits, throughput);
+        if (collect_stats)
+            partition_stats_print(&stats, stderr);
     }
 
     // Cleanup.
+    partition_stats_free(&stats);
+    bloom_set_free(&bloom);
     free(tuples);
     free(indep_big_block);
     free(global_indep_buffers);
@@ -0,0 +1,177 @@
+#define _GNU_SOURCE
+#include "project.h"
+#include "utils.h"
+#include "tasks.h"
+#include "partitions.h"
+#include "join.h"
+#include "bloom.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Per-worker hash table storage, sized for the largest R partition and reused across tasks.
+typedef struct {
+    tuple_t *build_tuples;   // Contiguous copy of the R partition.
+    int *next;               // Bucket chains, indexed like build_tuples.
+    int *heads;              // Bucket heads, -1 when empty.
+    long long matches;
+    long long filtered;
+    double build_ms;
+    double probe_ms;
+} join_worker_t;
+
+typedef struct {
+    const partition_set_t *r_set;
+    const partition_set_t *s_set;
+    const bloom_set_t *bloom;  // Filters over the R partitions, or NULL.
+    join_worker_t *workers;
+} join_ctx_t;
+
+static void join_partition(int partition, int worker_id, void *void_ctx) {
+    join_ctx_t *ctx = (join_ctx_t *)void_ctx;
+    join_worker_t *w = &ctx->workers[worker_id];
+    const partition_set_t *r_set = ctx->r_set;
+    const partition_set_t *s_set = ctx->s_set;
+    int hash_bits = r_set->hash_bits;
+    struct timespec t0, t1, t2;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &t0);
+
+    // Build: copy the R fragments into one cache-resident array and chain them by bucket.
+    int build_count = partition_set_total(r_set, partition);
+    uint32_t table_size = 1;
+    while (table_size < (uint32_t)build_count)
+        table_size <<= 1;
+    uint32_t mask = table_size - 1;
+    memset(w->heads, -1, table_size * sizeof(int));
+
+    int n = 0;
+    for (int f = 0; f < r_set->fragment_count; f++) {
+        int slot = f * r_set->partition_count + partition;
+        const tuple_t *fragment = r_set->buffers[slot];
+        for (int j = 0; j < r_set->sizes[slot]; j++) {
+            w->build_tuples[n] = fragment[j];
+            uint32_t bucket = hash_bucket(hash_key(fragment[j].key), hash_bits, mask);
+            w->next[n] = w->heads[bucket];
+            w->heads[bucket] = n;
+            n++;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &t1);
+
+    // Probe with every S tuple of the same partition.
+    const bloom_set_t *bloom = ctx->bloom;
+    long long matches = 0, filtered = 0;
+    for (int f = 0; f < s_set->fragment_count; f++) {
+        int slot = f * s_set->partition_count + partition;
+        const tuple_t *fragment = s_set->buffers[slot];
+        for (int j = 0; j < s_set->sizes[slot]; j++) {
+            if (bloom && !bloom_query(bloom, partition, fragment[j].key)) {
+                filtered++;
+                continue;
+            }
+            uint32_t bucket = hash_bucket(hash_key(fragment[j].key), hash_bits, mask);
+            for (int e = w->heads[bucket]; e >= 0; e = w->next[e]) {
+                if (memcmp(w->build_tuples[e].key, fragment[j].key, sizeof(fragment[j].key)) == 0)
+                    matches++;
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &t2);
+    w->matches += matches;
+    w->filtered += filtered;
+    w->build_ms += elapsed_ms(&t0, &t1);
+    w->probe_ms += elapsed_ms(&t1, &t2);
+}
+
+int run_radix_join_timed(tuple_t *r, int r_count, tuple_t *s, int s_count, int thread_count, int hash_bits,
+                         strategy_t strategy, int bloom_bits_per_key, join_result_t *result) {
+    if (!r || !s || !result)
+        return -1;
+
+    partition_set_t r_set, s_set;
+    if (partition_set_init(&r_set, strategy, r_count, thread_count, hash_bits) != 0)
+        return -1;
+    if (partition_set_init(&s_set, strategy, s_count, thread_count, hash_bits) != 0) {
+        partition_set_free(&r_set);
+        return -1;
+    }
+
+    int ret = -1;
+    bloom_set_t bloom = {0};
+    partition_opts_t r_opts = {0};
+    join_worker_t *workers = calloc(thread_count, sizeof(join_worker_t));
+    if (!workers)
+        goto out;
+    if (bloom_bits_per_key > 0) {
+        if (bloom_set_init(&bloom, r_set.partition_count, thread_count, r_count / r_set.partition_count,
+                           bloom_bits_per_key) != 0) {
+            fprintf(stderr, "Error allocating Bloom filters.\n");
+            goto out;
+        }
+        r_opts.bloom = &bloom;
+    }
+
+    struct timespec start, partitioned, end;
+    double throughput;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    if (run_strategy_timed(&r_set, r, r_count, thread_count, &throughput, &r_opts) != 0 ||
+        run_strategy_timed(&s_set, s, s_count, thread_count, &throughput, NULL) != 0)
+        goto out;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &partitioned);
+
+    // Size the per-worker tables for the largest build partition.
+    int max_build = 1;
+    for (int p = 0; p < r_set.partition_count; p++) {
+        int total = partition_set_total(&r_set, p);
+        if (total > max_build)
+            max_build = total;
+    }
+    int max_table = 1;
+    while (max_table < max_build)
+        max_table <<= 1;
+    for (int i = 0; i < thread_count; i++) {
+        workers[i].build_tuples = malloc(max_build * sizeof(tuple_t));
+        workers[i].next = malloc(max_build * sizeof(int));
+        workers[i].heads = malloc(max_table * sizeof(int));
+        if (!workers[i].build_tuples || !workers[i].next || !workers[i].heads) {
+            fprintf(stderr, "Error allocating join hash tables.\n");
+            goto out;
+        }
+    }
+
+    join_ctx_t ctx = {.r_set = &r_set, .s_set = &s_set, .bloom = r_opts.bloom, .workers = workers};
+    if (run_tasks(thread_count, r_set.partition_count, join_partition, &ctx) != 0)
+        goto out;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+
+    memset(result, 0, sizeof(*result));
+    for (int i = 0; i < thread_count; i++) {
+        result->matches += workers[i].matches;
+        result->filtered += workers[i].filtered;
+        result->build_ms += workers[i].build_ms;
+        result->probe_ms += workers[i].probe_ms;
+    }
+    result->build_ms /= thread_count;
+    result->probe_ms /= thread_count;
+    result->partition_ms = elapsed_ms(&start, &partitioned);
+    result->total_ms = elapsed_ms(&start, &end);
+    result->throughput = ((double)r_count + s_count) / (result->total_ms / 1000.0) / 1e6;
+    ret = 0;
+
+out:
+    if (workers) {
+        for (int i = 0; i < thread_count; i++) {
+            free(workers[i].build_tuples);
+            free(workers[i].next);
+            free(workers[i].heads);
+        }
+        free(workers);
+    }
+    bloom_set_free(&bloom);
+    partition_set_free(&r_set);
+    partition_set_free(&s_set);
+    return ret;
+}
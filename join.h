@@ -0,0 +1,24 @@
+#ifndef JOIN_H
+#define JOIN_H
+
+#include "project.h"
+#include "partitions.h"
+
+typedef struct {
+    double partition_ms;   // Wall time to partition R and S.
+    double build_ms;       // Average per-thread time spent building hash tables.
+    double probe_ms;       // Average per-thread time spent probing them.
+    double total_ms;       // End-to-end wall time.
+    long long matches;     // Number of (r, s) pairs with equal keys.
+    long long filtered;    // S tuples rejected by the Bloom filters without touching a hash table.
+    double throughput;     // Millions of input tuples (|R| + |S|) per second.
+} join_result_t;
+
+// Radix hash join: partitions R and S with the given strategy, then builds a hash table
+// over each R partition and probes it with the matching S partition. Partition pairs
+// are scheduled across thread_count threads. With bloom_bits_per_key > 0, Bloom filters over
+// the R partitions are built while partitioning R and checked before every S probe.
+int run_radix_join_timed(tuple_t *r, int r_count, tuple_t *s, int s_count, int thread_count, int hash_bits,
+                         strategy_t strategy, int bloom_bits_per_key, join_result_t *result);
+
+#endif
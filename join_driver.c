@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "join.h"
+#include "partitions.h"
+#include "project.h"
+#include "tuples.h"
+
+#define TUPLE_COUNT (1 << 24)  // ~16 million tuples per relation
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS> [independent|concurrent] [MATCH_PERCENT] [BLOOM_BITS]\n",
+                argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[1]);
+    int hash_bits = atoi(argv[2]);
+    strategy_t strategy = STRATEGY_INDEPENDENT;
+    if (argc > 3 && parse_strategy(argv[3], &strategy) != 0) {
+        fprintf(stderr, "Unknown strategy '%s'\n", argv[3]);
+        return -1;
+    }
+    int match_percent = argc > 4 ? atoi(argv[4]) : 100;
+    int bloom_bits = argc > 5 ? atoi(argv[5]) : 0;
+    if (match_percent < 0 || match_percent > 100 || bloom_bits < 0) {
+        fprintf(stderr, "MATCH_PERCENT must be within 0..100 and BLOOM_BITS non-negative.\n");
+        return -1;
+    }
+
+    // R has random (practically unique) keys; MATCH_PERCENT of the S tuples take the key of a
+    // random R tuple and the rest keep their random keys, so a selective join (low percentage)
+    // leaves most probes without a partner.
+    tuple_t *r = generate_tuples(TUPLE_COUNT);
+    tuple_t *s = generate_tuples(TUPLE_COUNT);
+    if (!r || !s) {
+        fprintf(stderr, "Error generating tuples.\n");
+        free(r);
+        free(s);
+        return -1;
+    }
+    for (int i = 0; i < TUPLE_COUNT; i++) {
+        unsigned int pick, roll;
+        memcpy(&pick, s[i].value, sizeof(pick));
+        memcpy(&roll, s[i].value + sizeof(pick), sizeof(roll));
+        if ((int)(roll % 100) < match_percent)
+            memcpy(s[i].key, r[pick % TUPLE_COUNT].key, sizeof(s[i].key));
+    }
+
+    join_result_t result;
+    if (run_radix_join_timed(r, TUPLE_COUNT, s, TUPLE_COUNT, thread_count, hash_bits, strategy, bloom_bits,
+                             &result) != 0) {
+        fprintf(stderr, "Error in %s join with %d threads and %d hashbits\n", strategy_name(strategy),
+                thread_count, hash_bits);
+    } else {
+        printf("Threads,HashBits,Strategy,MatchPercent,BloomBits,Throughput,PartitionMs,BuildMs,ProbeMs,Matches,"
+               "Filtered\n");
+        printf("%d,%d,%s,%d,%d,%.2f,%.1f,%.1f,%.1f,%lld,%lld\n", thread_count, hash_bits, strategy_name(strategy),
+               match_percent, bloom_bits, result.throughput, result.partition_ms, result.build_ms, result.probe_ms,
+               result.matches, result.filtered);
+    }
+
+    free(r);
+    free(s);
+    return 0;
+}
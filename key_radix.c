@@ -0,0 +1,88 @@
+#include "project.h"
+#include "utils.h"
+#include "tasks.h"
+#include "key_radix.h"
+#include <stdio.h>
+#include <time.h>
+
+typedef struct {
+    const tuple_t *tuples;
+    int tuple_count;
+    int thread_count;
+    const key_layout_t *layout;
+    unsigned char **buffers;
+    size_t *sizes;
+    size_t capacity;
+} key_radix_ctx_t;
+
+int key_layout_init(key_layout_t *layout, int key_bits, int radix_bits, int truncate) {
+    if (key_bits < 1 || key_bits > 64 || radix_bits < 0 || radix_bits > 30 || radix_bits > key_bits)
+        return -1;
+    layout->key_bits = key_bits;
+    layout->radix_bits = radix_bits;
+    layout->key_bytes = truncate ? (key_bits - radix_bits + 7) / 8 : 8;
+    layout->record_bytes = layout->key_bytes + (int)sizeof(((tuple_t *)0)->value);
+    return 0;
+}
+
+void decode_record(const key_layout_t *layout, int partition, const unsigned char *record, tuple_t *out) {
+    // A record is at least 8 bytes long, so the 8-byte load stays inside it.
+    uint64_t key = load_u64(record);
+    if (layout->key_bytes < 8) {
+        key &= (1ULL << (8 * layout->key_bytes)) - 1;
+        key = (key << layout->radix_bits) | (uint64_t)partition;
+    }
+    memcpy(out->key, &key, 8);
+    memcpy(out->value, record + layout->key_bytes, 8);
+}
+
+void decode_partition(const key_layout_t *layout, int partition, const unsigned char *records, int count,
+                      tuple_t *out) {
+    for (int i = 0; i < count; i++)
+        decode_record(layout, partition, records + (size_t)i * layout->record_bytes, &out[i]);
+}
+
+static void partition_slice(int task_id, int worker_id, void *arg) {
+    (void)worker_id;
+    key_radix_ctx_t *ctx = (key_radix_ctx_t *)arg;
+    const key_layout_t *layout = ctx->layout;
+    int partition_count = 1 << layout->radix_bits;
+    int base = ctx->tuple_count / ctx->thread_count;
+    int begin = task_id * base;
+    int end = task_id == ctx->thread_count - 1 ? ctx->tuple_count : begin + base;
+    unsigned char **buffers = ctx->buffers + (size_t)task_id * partition_count;
+    size_t *sizes = ctx->sizes + (size_t)task_id * partition_count;
+
+    for (int i = begin; i < end; i++) {
+        int p = key_radix_partition(ctx->tuples[i].key, layout->radix_bits);
+        size_t idx = sizes[p];
+        if (idx >= ctx->capacity) {
+            fprintf(stderr, "Thread %d: Partition %d overflow (idx=%zu, cap=%zu)\n", task_id + 1, p, idx,
+                    ctx->capacity);
+            continue;
+        }
+        encode_record(layout, &ctx->tuples[i], buffers[p] + (size_t)idx * layout->record_bytes);
+        sizes[p] = idx + 1;
+    }
+}
+
+int run_key_radix_timed(const tuple_t *tuples, int tuple_count, int thread_count, const key_layout_t *layout,
+                        unsigned char **buffers, size_t *sizes, size_t capacity, double *throughput) {
+    if (!tuples || !layout || !buffers || !sizes || !throughput || thread_count <= 0)
+        return -1;
+
+    int partition_count = 1 << layout->radix_bits;
+    memset(sizes, 0, (size_t)thread_count * partition_count * sizeof(size_t));
+    key_radix_ctx_t ctx = {tuples, tuple_count, thread_count, layout, buffers, sizes, capacity};
+
+    // One task per thread, so each thread fills its own fragment like the independent strategy.
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    int ret = run_tasks(thread_count, thread_count, partition_slice, &ctx);
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+    if (ret != 0)
+        return -1;
+
+    *throughput = ((double)tuple_count / (elapsed_ms(&start, &end) / 1000.0)) / 1e6;
+    return 0;
+}
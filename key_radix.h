@@ -0,0 +1,50 @@
+#ifndef KEY_RADIX_H
+#define KEY_RADIX_H
+
+#include <stdint.h>
+#include <string.h>
+#include "project.h"
+#include "utils.h"
+
+// Radix partitioning on the low key bits instead of a Murmur hash, for keys that are already
+// well distributed. Partition p holds exactly the keys whose low radix_bits bits equal p, so
+// records only store key >> radix_bits, in as few bytes as the remaining significant bits need.
+// A record is the truncated key (key_bytes, little-endian) followed by the 8 value bytes.
+typedef struct {
+    int key_bits;      // Significant key bits; keys must be below 2^key_bits.
+    int radix_bits;
+    int key_bytes;     // Stored key bytes: ceil((key_bits - radix_bits) / 8), or 8 untruncated.
+    int record_bytes;  // key_bytes + sizeof value.
+} key_layout_t;
+
+// truncate = 0 keeps full 8-byte keys, which gives the plain radix baseline.
+// Returns 0 on success, -1 on invalid bit counts.
+int key_layout_init(key_layout_t *layout, int key_bits, int radix_bits, int truncate);
+
+static inline int key_radix_partition(const unsigned char *key, int radix_bits) {
+    return (int)(load_u64(key) & ((1ULL << radix_bits) - 1));
+}
+
+// Writes one record. The key is stored with a full 8-byte write whose excess bytes the value
+// write then overwrites, so no variable-length copy is needed (assumes a little-endian host).
+static inline void encode_record(const key_layout_t *layout, const tuple_t *tuple, unsigned char *record) {
+    uint64_t key = load_u64(tuple->key);
+    if (layout->key_bytes < 8)
+        key >>= layout->radix_bits;
+    memcpy(record, &key, 8);
+    memcpy(record + layout->key_bytes, tuple->value, 8);
+}
+
+// Restores the full tuple of a record stored in partition.
+void decode_record(const key_layout_t *layout, int partition, const unsigned char *record, tuple_t *out);
+
+// Decodes count records of partition into out.
+void decode_partition(const key_layout_t *layout, int partition, const unsigned char *records, int count,
+                      tuple_t *out);
+
+// Independent-style radix partitioning into per-thread fragments: buffers[thr * P + p] holds
+// capacity records of layout->record_bytes and sizes[thr * P + p] counts them.
+int run_key_radix_timed(const tuple_t *tuples, int tuple_count, int thread_count, const key_layout_t *layout,
+                        unsigned char **buffers, size_t *sizes, size_t capacity, double *throughput);
+
+#endif
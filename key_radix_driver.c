@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "key_radix.h"
+#include "partitions.h"
+#include "project.h"
+#include "utils.h"
+#include "tuples.h"
+
+#define TUPLE_COUNT (1 << 24)  // ~16 million tuples
+
+// Order-independent fingerprint of a set of tuples, to check that decoding restores the input.
+static uint64_t fingerprint(const tuple_t *tuple) {
+    uint64_t key = load_u64(tuple->key);
+    uint64_t value = load_u64(tuple->value);
+    return (key * 0x9E3779B97F4A7C15ULL) ^ (value + (key << 7));
+}
+
+// Throughput in millions of tuples per second over the wall-clock time of a whole run. Both the
+// hash baseline and the radix layouts are timed this way, around the call that partitions, since
+// run_independent_timed reports the mean thread time instead.
+static double wall_throughput(const struct timespec *start, const struct timespec *end) {
+    return ((double)TUPLE_COUNT / (elapsed_ms(start, end) / 1000.0)) / 1e6;
+}
+
+// Runs the radix kernel with layout and returns its throughput, or a negative value on error.
+// Every record is then decoded and checked against its partition and the input.
+static double run_layout(const tuple_t *tuples, int thread_count, const key_layout_t *layout, uint64_t expected,
+                         double *bytes_per_tuple) {
+    int partition_count = 1 << layout->radix_bits;
+    size_t capacity = (TUPLE_COUNT / partition_count) * PARTITION_MULTIPLIER;
+    size_t buffer_count = (size_t)thread_count * partition_count;
+    unsigned char *block = malloc(buffer_count * capacity * layout->record_bytes);
+    unsigned char **buffers = malloc(buffer_count * sizeof(unsigned char *));
+    size_t *sizes = calloc(buffer_count, sizeof(size_t));
+    double throughput = -1.0;
+    if (!block || !buffers || !sizes) {
+        fprintf(stderr, "Error allocating partition buffers.\n");
+        goto out;
+    }
+    for (size_t i = 0; i < buffer_count; i++)
+        buffers[i] = block + i * capacity * layout->record_bytes;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    if (run_key_radix_timed(tuples, TUPLE_COUNT, thread_count, layout, buffers, sizes, capacity, &throughput) != 0) {
+        throughput = -1.0;
+        goto out;
+    }
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+    throughput = wall_throughput(&start, &end);
+
+    long records = 0;
+    uint64_t decoded = 0;
+    for (size_t i = 0; i < buffer_count; i++) {
+        int partition = (int)(i % partition_count);
+        records += (long)sizes[i];
+        for (size_t j = 0; j < sizes[i]; j++) {
+            tuple_t tuple;
+            decode_record(layout, partition, buffers[i] + (size_t)j * layout->record_bytes, &tuple);
+            if (key_radix_partition(tuple.key, layout->radix_bits) != partition) {
+                fprintf(stderr, "Key decoded into the wrong partition %d.\n", partition);
+                throughput = -1.0;
+                goto out;
+            }
+            decoded += fingerprint(&tuple);
+        }
+    }
+    if (records != TUPLE_COUNT || decoded != expected) {
+        fprintf(stderr, "Decoded records do not match the input.\n");
+        throughput = -1.0;
+        goto out;
+    }
+    *bytes_per_tuple = (double)records * layout->record_bytes / TUPLE_COUNT;
+
+out:
+    free(block);
+    free(buffers);
+    free(sizes);
+    return throughput;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS> [KEY_BITS]\n", argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[1]);
+    int hash_bits = atoi(argv[2]);
+    int key_bits = argc > 3 ? atoi(argv[3]) : 64;
+
+    // Narrower keys repeat so often that whole keys pile up in one partition and overflow the
+    // fixed PARTITION_MULTIPLIER buffers; 32 bits keep 2^24 random keys practically unique.
+    if (key_bits < 32) {
+        fprintf(stderr, "KEY_BITS must be at least 32.\n");
+        return -1;
+    }
+    key_layout_t full, truncated;
+    if (key_layout_init(&full, key_bits, hash_bits, 0) != 0 || key_layout_init(&truncated, key_bits, hash_bits, 1) != 0) {
+        fprintf(stderr, "Invalid KEY_BITS %d for %d hashbits.\n", key_bits, hash_bits);
+        return -1;
+    }
+
+    // Generate tuples, keeping only the low key_bits bits of each (random) key.
+    tuple_t *tuples = generate_tuples(TUPLE_COUNT);
+    if (!tuples) {
+        fprintf(stderr, "Error generating tuples.\n");
+        return -1;
+    }
+    uint64_t key_mask = key_bits == 64 ? ~0ULL : (1ULL << key_bits) - 1;
+    uint64_t expected = 0;
+    for (int i = 0; i < TUPLE_COUNT; i++) {
+        uint64_t key = load_u64(tuples[i].key) & key_mask;
+        memcpy(tuples[i].key, &key, sizeof(key));
+        expected += fingerprint(&tuples[i]);
+    }
+
+    // Murmur-hashed independent partitioning of full tuples as the baseline.
+    partition_set_t set;
+    double hash_throughput = -1.0;
+    if (partition_set_init(&set, STRATEGY_INDEPENDENT, TUPLE_COUNT, thread_count, hash_bits) == 0) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+        if (run_strategy_timed(&set, tuples, TUPLE_COUNT, thread_count, &hash_throughput, NULL) == 0) {
+            clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+            hash_throughput = wall_throughput(&start, &end);
+        } else {
+            hash_throughput = -1.0;
+        }
+        partition_set_free(&set);
+    }
+
+    double full_bytes = 0.0, truncated_bytes = 0.0;
+    double radix_throughput = run_layout(tuples, thread_count, &full, expected, &full_bytes);
+    double truncated_throughput = run_layout(tuples, thread_count, &truncated, expected, &truncated_bytes);
+
+    if (hash_throughput < 0 || radix_throughput < 0 || truncated_throughput < 0) {
+        fprintf(stderr, "Error in key radix run with %d threads and %d hashbits\n", thread_count, hash_bits);
+    } else {
+        printf("Threads,HashBits,KeyBits,HashThroughput,RadixThroughput,TruncatedThroughput,"
+               "HashBytesPerTuple,RadixBytesPerTuple,TruncatedBytesPerTuple\n");
+        printf("%d,%d,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n", thread_count, hash_bits, key_bits, hash_throughput,
+               radix_throughput, truncated_throughput, (double)sizeof(tuple_t), full_bytes, truncated_bytes);
+    }
+
+    free(tuples);
+    return 0;
+}
@@ -0,0 +1,164 @@
+#define _GNU_SOURCE
+#include "project.h"
+#include "utils.h"
+#include "affinity.h"
+#include "tasks.h"
+#include "late_materialization.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int thread_id;
+    tuple_t *tuples;
+    int tuples_index;       // Start index (inclusive)
+    int tuples_length;      // End index (exclusive)
+    int partition_count;
+    key_rid_t **pair_buffers; // This thread's slice of the pair buffers.
+    int *pair_sizes;
+    int capacity;
+    struct timespec start;
+    struct timespec end;
+} pair_args_t;
+
+typedef struct {
+    tuple_t *tuples;
+    int thread_count;
+    int partition_count;
+    key_rid_t **pair_buffers;
+    int *pair_sizes;
+    tuple_t *gathered;
+    int *partition_offsets;
+} gather_ctx_t;
+
+static void *write_pairs(void *void_args) {
+    pair_args_t *args = (pair_args_t *)void_args;
+
+    set_affinity(args->thread_id);
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &args->start);
+    for (int i = args->tuples_index; i < args->tuples_length; i++) {
+        int partition_id = hash_to_partition(args->tuples[i].key, args->partition_count);
+        int idx = args->pair_sizes[partition_id];
+        if (idx >= args->capacity) {
+            fprintf(stderr, "Thread %d: Partition %d overflow (idx=%d, cap=%d)\n",
+                    args->thread_id, partition_id, idx, args->capacity);
+            continue;
+        }
+        key_rid_t *pair = &args->pair_buffers[partition_id][idx];
+        memcpy(pair->key, args->tuples[i].key, sizeof(pair->key));
+        pair->row_id = (uint32_t)i;
+        args->pair_sizes[partition_id]++;
+    }
+    clock_gettime(CLOCK_MONOTONIC_RAW, &args->end);
+    return NULL;
+}
+
+// Copies the tuples referenced by every slice of one partition into its output range.
+static void gather_partition(int partition, int worker_id, void *void_ctx) {
+    (void)worker_id;
+    gather_ctx_t *ctx = (gather_ctx_t *)void_ctx;
+    tuple_t *out = ctx->gathered + ctx->partition_offsets[partition];
+
+    for (int thr = 0; thr < ctx->thread_count; thr++) {
+        int slot = thr * ctx->partition_count + partition;
+        const key_rid_t *pairs = ctx->pair_buffers[slot];
+        int size = ctx->pair_sizes[slot];
+        for (int j = 0; j < size; j++) {
+            *out++ = ctx->tuples[pairs[j].row_id];
+        }
+    }
+}
+
+int run_late_materialization_timed(tuple_t *tuples, int tuple_count, int thread_count, int hash_bits,
+                                   key_rid_t **pair_buffers, int *pair_sizes, int pair_capacity,
+                                   tuple_t *gathered, int *partition_offsets,
+                                   double *partition_throughput, double *gather_throughput) {
+    if (!tuples || !pair_buffers || !pair_sizes)
+        return -1;
+
+    int partition_count = 1 << hash_bits;
+    int base_segment_size = tuple_count / thread_count;
+
+    int used_partitions = thread_count * partition_count;
+    for (int i = 0; i < used_partitions; i++)
+        pair_sizes[i] = 0;
+
+    pthread_t *threads = malloc(thread_count * sizeof(pthread_t));
+    pair_args_t *args = malloc(thread_count * sizeof(pair_args_t));
+    if (!threads || !args) {
+        fprintf(stderr, "Error allocating memory for thread structures.\n");
+        free(threads);
+        free(args);
+        return -1;
+    }
+
+    // Partition phase.
+    for (int i = 0; i < thread_count; i++) {
+        int start_index = base_segment_size * i;
+        int end_index = (i == thread_count - 1) ? tuple_count : (start_index + base_segment_size);
+        args[i].thread_id = i + 1;
+        args[i].tuples = tuples;
+        args[i].tuples_index = start_index;
+        args[i].tuples_length = end_index;
+        args[i].partition_count = partition_count;
+        args[i].pair_buffers = pair_buffers + (i * partition_count);
+        args[i].pair_sizes = pair_sizes + (i * partition_count);
+        args[i].capacity = pair_capacity;
+        if (pthread_create(&threads[i], NULL, write_pairs, &args[i]) != 0) {
+            fprintf(stderr, "Error creating thread %d\n", i);
+            for (int j = 0; j < i; j++) {
+                pthread_join(threads[j], NULL);
+            }
+            free(threads);
+            free(args);
+            return -1;
+        }
+    }
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    double total_ms = 0.0;
+    for (int i = 0; i < thread_count; i++) {
+        total_ms += elapsed_ms(&args[i].start, &args[i].end);
+    }
+    double avg_time_sec = (total_ms / thread_count) / 1000.0;
+    *partition_throughput = ((double)tuple_count / avg_time_sec) / 1e6;
+    free(threads);
+    free(args);
+
+    *gather_throughput = 0.0;
+    if (!gathered)
+        return 0;
+    if (!partition_offsets)
+        return -1;
+
+    // Gather phase: prefix sum of the partition totals, then one task per partition.
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    partition_offsets[0] = 0;
+    for (int p = 0; p < partition_count; p++) {
+        int total = 0;
+        for (int thr = 0; thr < thread_count; thr++)
+            total += pair_sizes[thr * partition_count + p];
+        partition_offsets[p + 1] = partition_offsets[p] + total;
+    }
+
+    gather_ctx_t ctx = {
+        .tuples = tuples,
+        .thread_count = thread_count,
+        .partition_count = partition_count,
+        .pair_buffers = pair_buffers,
+        .pair_sizes = pair_sizes,
+        .gathered = gathered,
+        .partition_offsets = partition_offsets,
+    };
+    if (run_tasks(thread_count, partition_count, gather_partition, &ctx) != 0)
+        return -1;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+
+    *gather_throughput = ((double)partition_offsets[partition_count] / (elapsed_ms(&start, &end) / 1000.0)) / 1e6;
+    return 0;
+}
@@ -0,0 +1,24 @@
+#ifndef LATE_MATERIALIZATION_H
+#define LATE_MATERIALIZATION_H
+
+#include <stdint.h>
+#include "project.h"
+
+// Compact partitioning entry: the key plus the row id of its tuple in the input array.
+typedef struct {
+    unsigned char key[8];
+    uint32_t row_id;
+} key_rid_t;
+
+// Partitions (key, row id) pairs into per-thread slices laid out like run_independent_timed:
+// slice i owns pair_buffers[i * partition_count .. (i + 1) * partition_count).
+// If gathered is non-NULL, a gather phase then rebuilds the full partitioned tuples into
+// gathered (tuple_count entries), one partition per task; partition p occupies
+// [partition_offsets[p], partition_offsets[p + 1]). partition_offsets needs partition_count + 1 entries.
+// Throughputs are in millions of tuples/sec; gather_throughput is 0 when no gather is run.
+int run_late_materialization_timed(tuple_t *tuples, int tuple_count, int thread_count, int hash_bits,
+                                   key_rid_t **pair_buffers, int *pair_sizes, int pair_capacity,
+                                   tuple_t *gathered, int *partition_offsets,
+                                   double *partition_throughput, double *gather_throughput);
+
+#endif
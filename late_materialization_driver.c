@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "independent.h"
+#include "late_materialization.h"
+#include "project.h"
+#include "utils.h"
+#include "tuples.h"
+
+#define TUPLE_COUNT (1 << 24)  // ~16 million tuples
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS> [GATHER]\n", argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[1]);
+    int hash_bits = atoi(argv[2]);
+    int gather = argc > 3 ? atoi(argv[3]) : 1;
+
+    tuple_t *tuples = generate_tuples(TUPLE_COUNT);
+    if (!tuples) {
+        fprintf(stderr, "Error generating tuples.\n");
+        return -1;
+    }
+
+    int partitions_per_thread = 1 << hash_bits;
+    int total_partitions = thread_count * partitions_per_thread;
+    int effective_capacity = (TUPLE_COUNT / partitions_per_thread) * PARTITION_MULTIPLIER;
+
+    // Baseline: full-tuple independent partitioning with the same buffer layout.
+    double full_throughput = 0.0;
+    {
+        tuple_t *big_block = malloc((size_t)thread_count * TUPLE_COUNT * PARTITION_MULTIPLIER * sizeof(tuple_t));
+        tuple_t **buffers = malloc(total_partitions * sizeof(tuple_t *));
+        size_t *sizes = calloc(total_partitions, sizeof(size_t));
+        if (!big_block || !buffers || !sizes) {
+            free(tuples);
+            free(big_block);
+            free(buffers);
+            free(sizes);
+            return -1;
+        }
+        for (int i = 0; i < total_partitions; i++)
+            buffers[i] = big_block + (size_t)i * effective_capacity;
+        if (run_independent_timed(tuples, TUPLE_COUNT, thread_count, hash_bits, buffers, sizes,
+                                  effective_capacity, &full_throughput, NULL) != 0) {
+            fprintf(stderr, "Error in independent run with %d threads and %d hashbits\n", thread_count, hash_bits);
+        }
+        free(big_block);
+        free(buffers);
+        free(sizes);
+    }
+
+    // Late materialization: (key, row id) pairs, then an optional gather.
+    key_rid_t *pair_block = malloc((size_t)total_partitions * effective_capacity * sizeof(key_rid_t));
+    key_rid_t **pair_buffers = malloc(total_partitions * sizeof(key_rid_t *));
+    int *pair_sizes = calloc(total_partitions, sizeof(int));
+    tuple_t *gathered = gather ? malloc(TUPLE_COUNT * sizeof(tuple_t)) : NULL;
+    int *partition_offsets = malloc((partitions_per_thread + 1) * sizeof(int));
+    if (!pair_block || !pair_buffers || !pair_sizes || (gather && !gathered) || !partition_offsets) {
+        free(tuples);
+        free(pair_block);
+        free(pair_buffers);
+        free(pair_sizes);
+        free(gathered);
+        free(partition_offsets);
+        return -1;
+    }
+    for (int i = 0; i < total_partitions; i++)
+        pair_buffers[i] = pair_block + (size_t)i * effective_capacity;
+
+    double partition_throughput = 0.0;
+    double gather_throughput = 0.0;
+    if (run_late_materialization_timed(tuples, TUPLE_COUNT, thread_count, hash_bits, pair_buffers, pair_sizes,
+                                       effective_capacity, gathered, partition_offsets,
+                                       &partition_throughput, &gather_throughput) != 0) {
+        fprintf(stderr, "Error in late materialization run with %d threads and %d hashbits\n",
+                thread_count, hash_bits);
+    } else {
+        if (gather && partition_offsets[partitions_per_thread] != TUPLE_COUNT)
+            fprintf(stderr, "Gathered %d of %d tuples\n", partition_offsets[partitions_per_thread], TUPLE_COUNT);
+        // End-to-end rate of partitioning pairs and then gathering the full tuples.
+        double late_throughput = partition_throughput;
+        if (gather_throughput > 0.0)
+            late_throughput = 1.0 / (1.0 / partition_throughput + 1.0 / gather_throughput);
+        printf("Threads,HashBits,FullThroughput,PairThroughput,GatherThroughput,LateThroughput\n");
+        printf("%d,%d,%.2f,%.2f,%.2f,%.2f\n", thread_count, hash_bits, full_throughput, partition_throughput,
+               gather_throughput, late_throughput);
+    }
+
+    free(tuples);
+    free(pair_block);
+    free(pair_buffers);
+    free(pair_sizes);
+    free(gathered);
+    free(partition_offsets);
+    return 0;
+}
@@ -0,0 +1,190 @@
+#include "libpartition.h"
+#include "chunk_store.h"
+#include "thpool.h"
+#include "trace.h"
+#include "utils.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+// Batches are split into slices of at least this many tuples; smaller batches are partitioned
+// on the calling thread, where waking the workers would cost more than the work itself. Kept
+// well below the default batch of 4096 (make run_streaming), which thus spans up to 4 workers.
+#define MIN_SLICE_TUPLES 1024
+
+typedef struct {
+    partitioner_t *partitioner;
+    const tuple_t *tuples;
+    int begin;
+    int end;
+    int slice;              // Selects the chunk pool and, for the independent strategy, the fragment.
+} slice_job_t;
+
+struct partitioner {
+    partitioner_strategy_t strategy;
+    int thread_count;
+    int partition_count;
+    threadpool pool;
+    chunk_store_t store;
+    pthread_mutex_t *mutexes;  // Concurrent strategy only.
+    slice_job_t *jobs;
+    long stored;
+};
+
+static void scatter_independent(const slice_job_t *job) {
+    partitioner_t *p = job->partitioner;
+    chunk_list_t *lists = p->store.lists + (size_t)job->slice * p->partition_count;
+    chunk_pool_t *pool = &p->store.pools[job->slice];
+    for (int i = job->begin; i < job->end; i++) {
+        int partition = hash_to_partition(job->tuples[i].key, p->partition_count);
+        chunk_list_append(&lists[partition], pool, &job->tuples[i]);
+    }
+}
+
+// Same reserve-under-lock, write-after-unlock scheme as write_to_chunks in concurrent.c.
+static void scatter_concurrent(const slice_job_t *job) {
+    partitioner_t *p = job->partitioner;
+    chunk_pool_t *pool = &p->store.pools[job->slice];
+    for (int i = job->begin; i < job->end; i++) {
+        int partition = hash_to_partition(job->tuples[i].key, p->partition_count);
+        chunk_list_t *list = &p->store.lists[partition];
+        TRACE_LOCK(&p->mutexes[partition]);
+        chunk_t *tail = list->tail;
+        if (!tail || tail->count == tail->capacity)
+            tail = chunk_list_grow(list, pool);
+        tuple_t *slot = &tail->tuples[tail->count++];
+        pthread_mutex_unlock(&p->mutexes[partition]);
+        *slot = job->tuples[i];
+    }
+}
+
+static void run_slice(void *arg) {
+    slice_job_t *job = (slice_job_t *)arg;
+    TRACE_BEGIN("scatter");
+    if (job->partitioner->strategy == PARTITIONER_INDEPENDENT)
+        scatter_independent(job);
+    else
+        scatter_concurrent(job);
+    TRACE_END("scatter");
+}
+
+partitioner_t *partitioner_create(const partitioner_config_t *config) {
+    if (!config || config->thread_count <= 0 || config->hash_bits < 0 || config->hash_bits > 30)
+        return NULL;
+    if (config->strategy != PARTITIONER_INDEPENDENT && config->strategy != PARTITIONER_CONCURRENT)
+        return NULL;
+
+    partitioner_t *p = calloc(1, sizeof(partitioner_t));
+    if (!p)
+        return NULL;
+    p->strategy = config->strategy;
+    p->thread_count = config->thread_count;
+    p->partition_count = 1 << config->hash_bits;
+
+    int fragments = p->strategy == PARTITIONER_INDEPENDENT ? p->thread_count : 1;
+    if (chunk_store_init(&p->store, p->partition_count, fragments, p->thread_count) != 0) {
+        free(p);
+        return NULL;
+    }
+    p->jobs = calloc(p->thread_count, sizeof(slice_job_t));
+    if (p->strategy == PARTITIONER_CONCURRENT) {
+        p->mutexes = malloc(p->partition_count * sizeof(pthread_mutex_t));
+        if (p->mutexes) {
+            for (int i = 0; i < p->partition_count; i++)
+                pthread_mutex_init(&p->mutexes[i], NULL);
+        }
+    }
+    if (p->thread_count > 1)
+        p->pool = thpool_init(p->thread_count);
+    if (!p->jobs || (p->strategy == PARTITIONER_CONCURRENT && !p->mutexes) || (p->thread_count > 1 && !p->pool)) {
+        partitioner_destroy(p);
+        return NULL;
+    }
+    return p;
+}
+
+int partitioner_push_batch(partitioner_t *p, const tuple_t *tuples, int count) {
+    if (!p || count < 0 || (count > 0 && !tuples))
+        return -1;
+
+    int slices = (count + MIN_SLICE_TUPLES - 1) / MIN_SLICE_TUPLES;
+    if (slices > p->thread_count)
+        slices = p->thread_count;
+
+    if (slices <= 1) {
+        slice_job_t job = {p, tuples, 0, count, 0};
+        run_slice(&job);
+    } else {
+        int base = count / slices;
+        int queued = 0;
+        for (int i = 0; i < slices; i++) {
+            p->jobs[i] = (slice_job_t){p, tuples, i * base, i == slices - 1 ? count : (i + 1) * base, i};
+            if (thpool_add_work(p->pool, run_slice, &p->jobs[i]) != 0)
+                break;
+            queued++;
+        }
+        thpool_wait(p->pool);
+        if (queued != slices)
+            return -1;
+    }
+    p->stored += count;
+    return 0;
+}
+
+long partitioner_flush(partitioner_t *p) {
+    if (!p)
+        return -1;
+    // push_batch already waits for its slices; this keeps callers independent of that.
+    TRACE_BEGIN("flush");
+    if (p->pool)
+        thpool_wait(p->pool);
+    TRACE_END("flush");
+    return p->stored;
+}
+
+int partitioner_iterate_partitions(partitioner_t *p, partition_visit_fn fn, void *ctx) {
+    if (!p || !fn)
+        return -1;
+    for (int partition = 0; partition < p->partition_count; partition++) {
+        for (int f = 0; f < p->store.fragment_count; f++) {
+            const chunk_list_t *list = &p->store.lists[(size_t)f * p->partition_count + partition];
+            for (const chunk_t *chunk = list->head; chunk; chunk = chunk->next) {
+                if (chunk->count == 0)
+                    continue;
+                int rc = fn(partition, chunk->tuples, chunk->count, ctx);
+                if (rc != 0)
+                    return rc;
+            }
+        }
+    }
+    return 0;
+}
+
+long partitioner_partition_size(const partitioner_t *p, int partition) {
+    if (!p || partition < 0 || partition >= p->partition_count)
+        return 0;
+    return chunk_store_partition_size(&p->store, partition);
+}
+
+void partitioner_reset(partitioner_t *p) {
+    if (!p)
+        return;
+    if (p->pool)
+        thpool_wait(p->pool);
+    chunk_store_reset(&p->store);
+    p->stored = 0;
+}
+
+void partitioner_destroy(partitioner_t *p) {
+    if (!p)
+        return;
+    if (p->pool)
+        thpool_destroy(p->pool);
+    if (p->mutexes) {
+        for (int i = 0; i < p->partition_count; i++)
+            pthread_mutex_destroy(&p->mutexes[i]);
+        free(p->mutexes);
+    }
+    chunk_store_free(&p->store);
+    free(p->jobs);
+    free(p);
+}
@@ -0,0 +1,57 @@
+#ifndef LIBPARTITION_H
+#define LIBPARTITION_H
+
+#include "project.h"
+
+// Push-based partitioner for ingest pipelines that receive tuples in batches rather than as
+// one big array. Worker threads and partition storage live as long as the partitioner, so a
+// batch only pays for hashing and scattering. Partitions grow in chunks (see chunk_store.h),
+// so no tuple count has to be known up front.
+//
+//     partitioner_t *p = partitioner_create(&config);
+//     while (next_batch(&batch, &count))
+//         partitioner_push_batch(p, batch, count);
+//     partitioner_flush(p);
+//     partitioner_iterate_partitions(p, visit, ctx);
+//     partitioner_destroy(p);
+
+typedef enum {
+    PARTITIONER_INDEPENDENT,  // Each worker appends to private per-partition chunk lists.
+    PARTITIONER_CONCURRENT,   // Workers share one chunk list per partition behind a mutex.
+} partitioner_strategy_t;
+
+typedef struct {
+    partitioner_strategy_t strategy;
+    int thread_count;
+    int hash_bits;
+} partitioner_config_t;
+
+typedef struct partitioner partitioner_t;
+
+// Called for each run of contiguous tuples of a partition; a partition may be visited several
+// times. Returning non-zero stops the iteration.
+typedef int (*partition_visit_fn)(int partition, const tuple_t *tuples, int count, void *ctx);
+
+// Returns NULL on invalid configurations or allocation failure.
+partitioner_t *partitioner_create(const partitioner_config_t *config);
+
+// Partitions count tuples on the worker threads. Returns once the batch is stored, so the
+// caller may reuse the batch memory immediately. Returns 0 on success, -1 on failure.
+int partitioner_push_batch(partitioner_t *partitioner, const tuple_t *tuples, int count);
+
+// Waits for outstanding work and returns the number of tuples stored since creation or the
+// last reset, or -1 on failure. Must be called before iterating.
+long partitioner_flush(partitioner_t *partitioner);
+
+// Visits partitions in order. Returns 0, or the first non-zero value returned by fn.
+int partitioner_iterate_partitions(partitioner_t *partitioner, partition_visit_fn fn, void *ctx);
+
+// Number of tuples in one partition.
+long partitioner_partition_size(const partitioner_t *partitioner, int partition);
+
+// Empties all partitions but keeps workers and chunk memory for the next window.
+void partitioner_reset(partitioner_t *partitioner);
+
+void partitioner_destroy(partitioner_t *partitioner);
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef MULTI_FANOUT_H
+#define MULTI_FANOUT_H
+
+#include "partitions.h"
+
+#define MULTI_FANOUT_MAX_SETS 8
+
+// Partitions tuples into every set in one scan: each tuple is read and hashed once, then stored
+// into each set at that set's fan-out (the low hash_bits of the same hash, so every set ends up
+// as hash_to_partition would partition it). The sets must use the independent strategy with
+// one fragment per thread; thread t scatters slice t into fragment t of each set. Tuples beyond
+// a buffer's capacity are dropped and reported. throughput is millions of input tuples per
+// second of wall time. Returns 0 on success, -1 on invalid sets.
+int run_multi_fanout_timed(const tuple_t *tuples, size_t tuple_count, int thread_count, partition_set_t *sets,
+                           int set_count, double *throughput);
+
+#endif
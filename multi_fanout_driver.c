@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "multi_fanout.h"
+#include "partitions.h"
+#include "project.h"
+#include "tuples.h"
+#include "utils.h"
+
+#define TUPLE_COUNT (1 << 24)  // ~16 million tuples
+
+// Parses a comma-separated list of hash bits such as "4,10,16". Returns the number of entries,
+// or -1 on malformed or out-of-range values.
+static int parse_fanouts(const char *arg, int *hash_bits) {
+    char copy[128];
+    snprintf(copy, sizeof(copy), "%s", arg);
+    int count = 0;
+    for (char *save = NULL, *token = strtok_r(copy, ",", &save); token; token = strtok_r(NULL, ",", &save)) {
+        char *end;
+        long bits = strtol(token, &end, 10);
+        if (*end != '\0' || bits < 1 || bits > 20 || count == MULTI_FANOUT_MAX_SETS)
+            return -1;
+        hash_bits[count++] = (int)bits;
+    }
+    return count;
+}
+
+// Checks that set holds the same partitions as reference, a separate run at the same fan-out: the
+// same number of tuples and, by checksum, the same keys and values in every partition, so that a
+// tuple stored in the wrong partition or corrupted on the way is caught too.
+static int same_partitions(const partition_set_t *set, const partition_set_t *reference) {
+    for (int p = 0; p < set->partition_count; p++) {
+        if (partition_set_total(set, p) != partition_set_total(reference, p)) {
+            fprintf(stderr, "Partition %d of fan-out 2^%d holds %zu tuples instead of %zu.\n", p, set->hash_bits,
+                    partition_set_total(set, p), partition_set_total(reference, p));
+            return -1;
+        }
+        if (partition_set_checksum(set, p) != partition_set_checksum(reference, p)) {
+            fprintf(stderr, "Partition %d of fan-out 2^%d holds different tuples.\n", p, set->hash_bits);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static double ms_for(double mtuples_per_sec) {
+    return TUPLE_COUNT / (mtuples_per_sec * 1e3);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <THREAD_COUNT> [HASHBITS,HASHBITS,...]\n", argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[1]);
+    int hash_bits[MULTI_FANOUT_MAX_SETS];
+    int fanout_count = parse_fanouts(argc > 2 ? argv[2] : "4,10,16", hash_bits);
+    if (fanout_count < 1) {
+        fprintf(stderr, "HASHBITS must be 1 to %d comma-separated values between 1 and 20.\n",
+                MULTI_FANOUT_MAX_SETS);
+        return -1;
+    }
+
+    tuple_t *tuples = generate_tuples(TUPLE_COUNT);
+    if (!tuples) {
+        fprintf(stderr, "Error generating tuples.\n");
+        return -1;
+    }
+    partition_set_t separate[MULTI_FANOUT_MAX_SETS] = {0}, shared[MULTI_FANOUT_MAX_SETS] = {0};
+    int status = -1;
+    for (int i = 0; i < fanout_count; i++) {
+        if (partition_set_init(&separate[i], STRATEGY_INDEPENDENT, TUPLE_COUNT, thread_count, hash_bits[i]) != 0 ||
+            partition_set_init(&shared[i], STRATEGY_INDEPENDENT, TUPLE_COUNT, thread_count, hash_bits[i]) != 0)
+            goto out;
+        // The shared sets are written again by every later row, so all sets start warm rather
+        // than only those.
+        partition_set_touch(&separate[i]);
+        partition_set_touch(&shared[i]);
+    }
+
+    // Row i weighs a single scan into the first i + 1 fan-outs against one scan per fan-out, so
+    // the growth of SinglePassMs from row to row is the scatter cost each extra target adds.
+    printf("Threads,HashBits,SeparateMs,SeparateTotalMs,SinglePassMs,Speedup\n");
+    double separate_total_ms = 0.0;
+    for (int i = 0; i < fanout_count; i++) {
+        struct timespec start, end;
+        double throughput;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+        if (run_strategy_timed(&separate[i], tuples, TUPLE_COUNT, thread_count, &throughput, NULL) != 0)
+            goto out;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+        double separate_ms = elapsed_ms(&start, &end);
+        separate_total_ms += separate_ms;
+
+        if (run_multi_fanout_timed(tuples, TUPLE_COUNT, thread_count, shared, i + 1, &throughput) != 0)
+            goto out;
+        for (int j = 0; j <= i; j++)
+            if (same_partitions(&shared[j], &separate[j]) != 0)
+                goto out;
+        double single_ms = ms_for(throughput);
+        printf("%d,%d,%.2f,%.2f,%.2f,%.2f\n", thread_count, hash_bits[i], separate_ms, separate_total_ms, single_ms,
+               separate_total_ms / single_ms);
+    }
+    status = 0;
+
+out:
+    for (int i = 0; i < fanout_count; i++) {
+        partition_set_free(&separate[i]);
+        partition_set_free(&shared[i]);
+    }
+    free(tuples);
+    return status;
+}
@@ -0,0 +1,183 @@
+#include "partition_file.h"
+#include "tasks.h"
+#include "trace.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef struct {
+    int fd;
+    int thread_count;
+    const partition_set_t *set;
+    const partition_file_entry_t *directory;
+    int failed;
+} write_ctx_t;
+
+static int pwrite_all(int fd, const void *data, size_t bytes, uint64_t offset) {
+    const unsigned char *p = (const unsigned char *)data;
+    while (bytes > 0) {
+        ssize_t written = pwrite(fd, p, bytes, (off_t)offset);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        p += written;
+        bytes -= (size_t)written;
+        offset += (uint64_t)written;
+    }
+    return 0;
+}
+
+// Task t writes partitions [t * P / T, (t + 1) * P / T), each fragment straight from its buffer.
+static void write_partition_range(int task_id, int worker_id, void *arg) {
+    (void)worker_id;
+    write_ctx_t *ctx = (write_ctx_t *)arg;
+    const partition_set_t *set = ctx->set;
+    int begin = (int)((long)set->partition_count * task_id / ctx->thread_count);
+    int end = (int)((long)set->partition_count * (task_id + 1) / ctx->thread_count);
+
+    TRACE_BEGIN("write");
+    for (int p = begin; p < end; p++) {
+        uint64_t offset = ctx->directory[p].offset;
+        for (int f = 0; f < set->fragment_count; f++) {
+            size_t slot = (size_t)f * set->partition_count + p;
+            size_t bytes = set->sizes[slot] * sizeof(tuple_t);
+            if (bytes > 0 && pwrite_all(ctx->fd, set->buffers[slot], bytes, offset) != 0) {
+                perror("pwrite");
+                __atomic_store_n(&ctx->failed, 1, __ATOMIC_RELAXED);
+                TRACE_END("write");
+                return;
+            }
+            offset += bytes;
+        }
+    }
+    TRACE_END("write");
+}
+
+int partition_file_write(const char *path, const partition_set_t *set, int thread_count, size_t *bytes) {
+    uint64_t page_size = (uint64_t)sysconf(_SC_PAGESIZE);
+    int partition_count = set->partition_count;
+    partition_file_entry_t *directory = malloc(partition_count * sizeof(partition_file_entry_t));
+    if (!directory) {
+        fprintf(stderr, "Error allocating the partition directory.\n");
+        return -1;
+    }
+
+    // Lay the partitions out on page boundaries, then the directory and the footer.
+    uint64_t offset = 0, tuple_count = 0;
+    for (int p = 0; p < partition_count; p++) {
+        directory[p].offset = offset;
+        directory[p].count = partition_set_total(set, p);
+        tuple_count += directory[p].count;
+        offset += (directory[p].count * sizeof(tuple_t) + page_size - 1) / page_size * page_size;
+    }
+    partition_file_footer_t footer;
+    memset(&footer, 0, sizeof(footer));
+    footer.directory_offset = offset;
+    footer.tuple_count = tuple_count;
+    footer.page_size = page_size;
+    footer.version = PARTITION_FILE_VERSION;
+    footer.tuple_size = sizeof(tuple_t);
+    footer.hash_bits = (uint32_t)set->hash_bits;
+    footer.hash_seed = 42;
+    footer.partition_count = (uint32_t)partition_count;
+    memcpy(footer.magic, PARTITION_FILE_MAGIC, sizeof(footer.magic));
+    uint64_t directory_bytes = (uint64_t)partition_count * sizeof(partition_file_entry_t);
+    uint64_t file_size = offset + directory_bytes + sizeof(footer);
+
+    int ret = -1;
+    int fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (fd < 0) {
+        perror(path);
+        free(directory);
+        return -1;
+    }
+    // Sizing the file first lets the writers fill disjoint ranges in any order.
+    if (ftruncate(fd, (off_t)file_size) != 0) {
+        perror("ftruncate");
+        goto out;
+    }
+
+    write_ctx_t ctx = {fd, thread_count, set, directory, 0};
+    if (run_tasks(thread_count, thread_count, write_partition_range, &ctx) != 0 || ctx.failed)
+        goto out;
+    if (pwrite_all(fd, directory, directory_bytes, offset) != 0 ||
+        pwrite_all(fd, &footer, sizeof(footer), offset + directory_bytes) != 0) {
+        perror("pwrite");
+        goto out;
+    }
+    if (fsync(fd) != 0) {
+        perror("fsync");
+        goto out;
+    }
+    *bytes = file_size;
+    ret = 0;
+
+out:
+    close(fd);
+    free(directory);
+    return ret;
+}
+
+int partition_file_open(const char *path, partition_file_t *file) {
+    memset(file, 0, sizeof(*file));
+    file->fd = open(path, O_RDONLY);
+    if (file->fd < 0) {
+        perror(path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(file->fd, &st) != 0 || (size_t)st.st_size < sizeof(partition_file_footer_t)) {
+        fprintf(stderr, "%s: not a partition file.\n", path);
+        goto fail;
+    }
+    file->size = (size_t)st.st_size;
+    file->base = mmap(NULL, file->size, PROT_READ, MAP_SHARED, file->fd, 0);
+    if (file->base == MAP_FAILED) {
+        perror("mmap");
+        file->base = NULL;
+        goto fail;
+    }
+
+    // Only the footer and directory are checked; the partitions are left to be paged in on use.
+    const partition_file_footer_t *footer =
+        (const partition_file_footer_t *)(file->base + file->size - sizeof(partition_file_footer_t));
+    uint64_t directory_bytes = (uint64_t)footer->partition_count * sizeof(partition_file_entry_t);
+    if (memcmp(footer->magic, PARTITION_FILE_MAGIC, sizeof(footer->magic)) != 0 ||
+        footer->version != PARTITION_FILE_VERSION || footer->tuple_size != sizeof(tuple_t) ||
+        footer->hash_bits > 30 || footer->partition_count != (1U << footer->hash_bits) || footer->page_size == 0 ||
+        footer->directory_offset + directory_bytes != file->size - sizeof(partition_file_footer_t)) {
+        fprintf(stderr, "%s: malformed partition file footer.\n", path);
+        goto fail;
+    }
+    const partition_file_entry_t *directory = (const partition_file_entry_t *)(file->base + footer->directory_offset);
+    for (uint32_t p = 0; p < footer->partition_count; p++) {
+        if (directory[p].offset % footer->page_size != 0 || directory[p].offset > footer->directory_offset ||
+            directory[p].count > (footer->directory_offset - directory[p].offset) / sizeof(tuple_t)) {
+            fprintf(stderr, "%s: partition %u lies outside the data section.\n", path, p);
+            goto fail;
+        }
+    }
+    file->footer = footer;
+    file->directory = directory;
+    return 0;
+
+fail:
+    partition_file_close(file);
+    return -1;
+}
+
+void partition_file_close(partition_file_t *file) {
+    if (file->base)
+        munmap(file->base, file->size);
+    if (file->fd >= 0)
+        close(file->fd);
+    memset(file, 0, sizeof(*file));
+    file->fd = -1;
+}
@@ -0,0 +1,62 @@
+#ifndef PARTITION_FILE_H
+#define PARTITION_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "partitions.h"
+#include "project.h"
+
+// On-disk partition file: every partition's tuples (all fragments back to back) start on a page
+// boundary, followed by a directory of (offset, count) entries and a fixed-size footer at the very
+// end of the file. Integers are native-endian; the file is meant to be reopened on the same machine.
+#define PARTITION_FILE_MAGIC "PARTFIL1"
+#define PARTITION_FILE_VERSION 1
+
+typedef struct {
+    uint64_t offset;            // Byte offset of the partition, a multiple of page_size.
+    uint64_t count;             // Tuples in the partition.
+} partition_file_entry_t;
+
+typedef struct {
+    uint64_t directory_offset;  // partition_count entries start here.
+    uint64_t tuple_count;
+    uint64_t page_size;
+    uint32_t version;
+    uint32_t tuple_size;        // sizeof(tuple_t) of the writer.
+    uint32_t hash_bits;         // Partition p holds the keys whose murmurhash3_32(key, 8, hash_seed)
+    uint32_t hash_seed;         // modulo 2^hash_bits is p.
+    uint32_t partition_count;
+    uint32_t reserved;
+    char magic[8];              // Last, so a truncated file fails the check.
+} partition_file_footer_t;
+
+// A file opened for reading: the whole file is mapped read-only and partitions point into it.
+typedef struct {
+    int fd;
+    size_t size;
+    unsigned char *base;
+    const partition_file_footer_t *footer;
+    const partition_file_entry_t *directory;
+} partition_file_t;
+
+// Writes set to path (created or truncated) with thread_count writer tasks, each storing a
+// contiguous range of partitions with pwrite, and syncs the file. Returns 0 on success, -1 on
+// error (reported on stderr); bytes receives the file size.
+int partition_file_write(const char *path, const partition_set_t *set, int thread_count, size_t *bytes);
+
+// Maps path and validates its footer and directory; no tuple data is read. Returns 0 on
+// success, -1 on I/O errors or malformed files.
+int partition_file_open(const char *path, partition_file_t *file);
+void partition_file_close(partition_file_t *file);
+
+static inline int partition_file_partitions(const partition_file_t *file) {
+    return (int)file->footer->partition_count;
+}
+
+// Zero-copy view of partition p; count receives its tuple count.
+static inline const tuple_t *partition_file_partition(const partition_file_t *file, int p, size_t *count) {
+    *count = file->directory[p].count;
+    return (const tuple_t *)(file->base + file->directory[p].offset);
+}
+
+#endif
@@ -0,0 +1,111 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "partition_file.h"
+#include "partitions.h"
+#include "project.h"
+#include "utils.h"
+#include "tuples.h"
+
+#define TUPLE_COUNT (1 << 24)  // ~16 million tuples
+
+// Reads every tuple of every partition through the mapping and checks that it hashes to the
+// partition it is stored in. Returns the number of tuples, or -1 on a misplaced tuple.
+static long scan_file(const partition_file_t *file) {
+    long total = 0;
+    int partition_count = partition_file_partitions(file);
+    for (int p = 0; p < partition_count; p++) {
+        size_t count;
+        const tuple_t *tuples = partition_file_partition(file, p, &count);
+        for (size_t i = 0; i < count; i++) {
+            if (hash_to_partition(tuples[i].key, partition_count) != p) {
+                fprintf(stderr, "Tuple %zu of partition %d does not belong there.\n", i, p);
+                return -1;
+            }
+        }
+        total += (long)count;
+    }
+    return total;
+}
+
+// Drops the file's pages from the page cache, so that the reload reads from the device as it
+// would in a later process. The file was synced, so none of its pages are dirty.
+static void drop_cached(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0 || posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) != 0)
+        fprintf(stderr, "Could not drop %s from the page cache; the reload is warm.\n", path);
+    if (fd >= 0)
+        close(fd);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS> [PATH]\n", argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[1]);
+    int hash_bits = atoi(argv[2]);
+    // Without a PATH the file is a scratch file removed after the run; with one it is kept, so
+    // another process can reopen it.
+    char path[256];
+    if (argc > 3) {
+        snprintf(path, sizeof(path), "%s", argv[3]);
+    } else {
+        const char *tmp = getenv("TMPDIR");
+        snprintf(path, sizeof(path), "%s/partitions_%d.bin", tmp ? tmp : "/tmp", (int)getpid());
+    }
+
+    tuple_t *tuples = generate_tuples(TUPLE_COUNT);
+    if (!tuples) {
+        fprintf(stderr, "Error generating tuples.\n");
+        return -1;
+    }
+    partition_set_t set;
+    double throughput;
+    if (partition_set_init(&set, STRATEGY_INDEPENDENT, TUPLE_COUNT, thread_count, hash_bits) != 0 ||
+        run_strategy_timed(&set, tuples, TUPLE_COUNT, thread_count, &throughput, NULL) != 0) {
+        fprintf(stderr, "Error partitioning tuples.\n");
+        free(tuples);
+        return -1;
+    }
+
+    // Write: parallel pwrite of the partition ranges plus fsync. Reload, from a cold page cache:
+    // open, map and validate the footer; the scan afterwards touches every page through the mapping.
+    struct timespec start, written, evicted, opened, scanned;
+    size_t bytes = 0;
+    partition_file_t file;
+    int status = -1;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    if (partition_file_write(path, &set, thread_count, &bytes) != 0)
+        goto out;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &written);
+    drop_cached(path);
+    clock_gettime(CLOCK_MONOTONIC_RAW, &evicted);
+    if (partition_file_open(path, &file) != 0)
+        goto out;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &opened);
+    long total = scan_file(&file);
+    clock_gettime(CLOCK_MONOTONIC_RAW, &scanned);
+    partition_file_close(&file);
+    if (total != TUPLE_COUNT) {
+        fprintf(stderr, "Reloaded file holds %ld of %d tuples.\n", total, TUPLE_COUNT);
+        goto out;
+    }
+
+    double write_ms = elapsed_ms(&start, &written);
+    double scan_ms = elapsed_ms(&opened, &scanned);
+    printf("Threads,HashBits,FileMiB,WriteGBs,OpenUs,ScanGBs\n");
+    printf("%d,%d,%.1f,%.2f,%.1f,%.2f\n", thread_count, hash_bits, bytes / 1048576.0, bytes / (write_ms * 1e6),
+           elapsed_ms(&evicted, &opened) * 1000.0, bytes / (scan_ms * 1e6));
+    status = 0;
+
+out:
+    if (argc <= 3)
+        unlink(path);
+    partition_set_free(&set);
+    free(tuples);
+    return status;
+}
@@ -0,0 +1,97 @@
+#include "partitions.h"
+#include "independent.h"
+#include "concurrent.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int parse_strategy(const char *name, strategy_t *strategy) {
+    if (strcmp(name, "independent") == 0) {
+        *strategy = STRATEGY_INDEPENDENT;
+        return 0;
+    }
+    if (strcmp(name, "concurrent") == 0) {
+        *strategy = STRATEGY_CONCURRENT;
+        return 0;
+    }
+    return -1;
+}
+
+const char *strategy_name(strategy_t strategy) {
+    return strategy == STRATEGY_CONCURRENT ? "concurrent" : "independent";
+}
+
+int partition_set_init(partition_set_t *set, strategy_t strategy, size_t tuple_count, int thread_count,
+                       int hash_bits) {
+    memset(set, 0, sizeof(*set));
+    set->strategy = strategy;
+    set->hash_bits = hash_bits;
+    set->partition_count = 1 << hash_bits;
+    set->fragment_count = strategy == STRATEGY_INDEPENDENT ? thread_count : 1;
+    set->capacity = (tuple_count / set->partition_count) * PARTITION_MULTIPLIER;
+
+    size_t buffer_count = (size_t)set->fragment_count * set->partition_count;
+    set->block = malloc(buffer_count * set->capacity * sizeof(tuple_t));
+    set->buffers = malloc(buffer_count * sizeof(tuple_t *));
+    set->sizes = calloc(buffer_count, sizeof(size_t));
+    if (!set->block || !set->buffers || !set->sizes) {
+        fprintf(stderr, "Error allocating partition buffers.\n");
+        partition_set_free(set);
+        return -1;
+    }
+    for (size_t i = 0; i < buffer_count; i++)
+        set->buffers[i] = set->block + i * set->capacity;
+    return 0;
+}
+
+void partition_set_free(partition_set_t *set) {
+    if (set->view) {
+        memset(set, 0, sizeof(*set));
+        return;
+    }
+    free(set->block);
+    free(set->buffers);
+    free(set->sizes);
+    set->block = NULL;
+    set->buffers = NULL;
+    set->sizes = NULL;
+}
+
+void partition_set_touch(partition_set_t *set) {
+    memset(set->block, 0, (size_t)set->fragment_count * set->partition_count * set->capacity * sizeof(tuple_t));
+}
+
+int run_strategy_timed(partition_set_t *set, tuple_t *tuples, size_t tuple_count, int thread_count,
+                       double *throughput, const partition_opts_t *opts) {
+    if (set->strategy == STRATEGY_INDEPENDENT) {
+        return run_independent_timed(tuples, tuple_count, thread_count, set->hash_bits, set->buffers, set->sizes,
+                                     set->capacity, throughput, opts);
+    }
+    return run_concurrent_timed(tuples, tuple_count, thread_count, set->partition_count, set->buffers, set->sizes,
+                                set->capacity, throughput, opts);
+}
+
+size_t partition_set_total(const partition_set_t *set, int partition) {
+    size_t total = 0;
+    for (int f = 0; f < set->fragment_count; f++)
+        total += set->sizes[(size_t)f * set->partition_count + partition];
+    return total;
+}
+
+uint64_t partition_set_checksum(const partition_set_t *set, int partition) {
+    uint64_t sum = 0;
+    for (int f = 0; f < set->fragment_count; f++) {
+        size_t i = (size_t)f * set->partition_count + partition;
+        for (size_t t = 0; t < set->sizes[i]; t++) {
+            // A full mix of each tuple, so that swapped or altered fields change the sum.
+            const tuple_t *tuple = &set->buffers[i][t];
+            uint64_t h = load_u64(tuple->key) * 0x9E3779B97F4A7C15ULL + load_u64(tuple->value);
+            h ^= h >> 29;
+            h *= 0xBF58476D1CE4E5B9ULL;
+            h ^= h >> 32;
+            sum += h;
+        }
+    }
+    return sum;
+}
@@ -0,0 +1,52 @@
+#ifndef PARTITIONS_H
+#define PARTITIONS_H
+
+#include <stdint.h>
+#include "project.h"
+
+typedef enum {
+    STRATEGY_INDEPENDENT,
+    STRATEGY_CONCURRENT,
+} strategy_t;
+
+// Output buffers of one partitioning run, allocated the same way as the drivers do.
+// Partition p is made of fragment_count buffers: buffers[f * partition_count + p] holding
+// sizes[f * partition_count + p] tuples. The independent strategy has one fragment per
+// thread, the concurrent strategy a single shared fragment.
+typedef struct {
+    strategy_t strategy;
+    int hash_bits;
+    int partition_count;
+    int fragment_count;
+    size_t capacity;       // Tuples per buffer (0 when buffers are packed back to back).
+    tuple_t *block;
+    tuple_t **buffers;
+    size_t *sizes;
+    int view;              // Borrows another set's arrays (coalesce_partitions); nothing to free.
+} partition_set_t;
+
+// Parses "independent" / "concurrent". Returns 0 on success, -1 on unknown names.
+int parse_strategy(const char *name, strategy_t *strategy);
+const char *strategy_name(strategy_t strategy);
+
+int partition_set_init(partition_set_t *set, strategy_t strategy, size_t tuple_count, int thread_count,
+                       int hash_bits);
+void partition_set_free(partition_set_t *set);
+
+// Writes every buffer of set once, so that benchmarks do not bill first-touch page faults to
+// whichever run fills the set first.
+void partition_set_touch(partition_set_t *set);
+
+// Partitions tuples into set with its strategy (run_independent_timed or run_concurrent_timed).
+// opts may be NULL.
+int run_strategy_timed(partition_set_t *set, tuple_t *tuples, size_t tuple_count, int thread_count,
+                       double *throughput, const partition_opts_t *opts);
+
+// Number of tuples in partition p across all of its fragments.
+size_t partition_set_total(const partition_set_t *set, int partition);
+
+// Order-independent checksum of the keys and values in partition p across all of its fragments:
+// two sets holding the same tuples in each partition, in any order, have equal checksums.
+uint64_t partition_set_checksum(const partition_set_t *set, int partition);
+
+#endif
@@ -0,0 +1,169 @@
+#include "predicate.h"
+#include "tasks.h"
+#include "trace.h"
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define PREDICATE_AVX2
+#endif
+
+void predicate_init(scan_predicate_t *predicate) {
+    predicate->key_low = 0;
+    predicate->key_high = UINT64_MAX;
+    predicate->value_low = 0;
+    predicate->value_high = UINT64_MAX;
+}
+
+int predicate_restrict_range(scan_predicate_t *predicate, predicate_column_t column, uint64_t low, uint64_t high) {
+    uint64_t *bounds = column == PREDICATE_KEY ? &predicate->key_low : &predicate->value_low;
+    if (low > bounds[0])
+        bounds[0] = low;
+    if (high < bounds[1])
+        bounds[1] = high;
+    return bounds[0] <= bounds[1] ? 0 : -1;
+}
+
+int predicate_restrict(scan_predicate_t *predicate, predicate_column_t column, predicate_op_t op, uint64_t constant) {
+    switch (op) {
+    case PREDICATE_LT:
+        return constant == 0 ? -1 : predicate_restrict_range(predicate, column, 0, constant - 1);
+    case PREDICATE_LE:
+        return predicate_restrict_range(predicate, column, 0, constant);
+    case PREDICATE_GT:
+        return constant == UINT64_MAX ? -1 : predicate_restrict_range(predicate, column, constant + 1, UINT64_MAX);
+    case PREDICATE_GE:
+        return predicate_restrict_range(predicate, column, constant, UINT64_MAX);
+    case PREDICATE_EQ:
+        return predicate_restrict_range(predicate, column, constant, constant);
+    }
+    return -1;
+}
+
+static size_t select_scalar(const scan_predicate_t *predicate, const tuple_t *tuples, size_t count, tuple_t *out) {
+    size_t selected = 0;
+    for (size_t i = 0; i < count; i++) {
+        out[selected] = tuples[i];
+        selected += predicate_match(predicate, &tuples[i]);
+    }
+    return selected;
+}
+
+#ifdef PREDICATE_AVX2
+// A 256-bit register holds two tuples, key and value lanes alternating, so one compare checks
+// both columns of both tuples. AVX2 only compares signed 64-bit integers, so both sides of
+// x - low <= high - low are offset by 2^63 first; a tuple qualifies when neither of its lanes
+// compared greater.
+__attribute__((target("avx2"))) static size_t select_avx2(const scan_predicate_t *predicate, const tuple_t *tuples,
+                                                          size_t count, tuple_t *out) {
+    const uint64_t key_width = predicate->key_high - predicate->key_low;
+    const uint64_t value_width = predicate->value_high - predicate->value_low;
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i low = _mm256_setr_epi64x((long long)predicate->key_low, (long long)predicate->value_low,
+                                           (long long)predicate->key_low, (long long)predicate->value_low);
+    const __m256i width = _mm256_xor_si256(
+        _mm256_setr_epi64x((long long)key_width, (long long)value_width, (long long)key_width, (long long)value_width),
+        sign);
+    size_t selected = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i front = _mm256_loadu_si256((const __m256i *)(tuples + i));
+        __m256i back = _mm256_loadu_si256((const __m256i *)(tuples + i + 2));
+        __m256i front_out = _mm256_cmpgt_epi64(_mm256_xor_si256(_mm256_sub_epi64(front, low), sign), width);
+        __m256i back_out = _mm256_cmpgt_epi64(_mm256_xor_si256(_mm256_sub_epi64(back, low), sign), width);
+        // Two bits per tuple, set for each column out of range.
+        int rejected = _mm256_movemask_pd(_mm256_castsi256_pd(front_out)) |
+                       _mm256_movemask_pd(_mm256_castsi256_pd(back_out)) << 4;
+        _mm_storeu_si128((__m128i *)(out + selected), _mm256_castsi256_si128(front));
+        selected += (rejected & 0x3) == 0;
+        _mm_storeu_si128((__m128i *)(out + selected), _mm256_extracti128_si256(front, 1));
+        selected += (rejected & 0xc) == 0;
+        _mm_storeu_si128((__m128i *)(out + selected), _mm256_castsi256_si128(back));
+        selected += (rejected & 0x30) == 0;
+        _mm_storeu_si128((__m128i *)(out + selected), _mm256_extracti128_si256(back, 1));
+        selected += (rejected & 0xc0) == 0;
+    }
+    return selected + select_scalar(predicate, tuples + i, count - i, out + selected);
+}
+#endif
+
+size_t predicate_select(const scan_predicate_t *predicate, const tuple_t *tuples, size_t count, tuple_t *out) {
+#ifdef PREDICATE_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        return select_avx2(predicate, tuples, count, out);
+#endif
+    return select_scalar(predicate, tuples, count, out);
+}
+
+// Prefetches the input window at tuples, up to end.
+static void prefetch_window(const tuple_t *tuples, const tuple_t *end) {
+    const char *bytes = (const char *)tuples;
+    const char *last = (const char *)(end - tuples < PREDICATE_WINDOW ? end : tuples + PREDICATE_WINDOW);
+    for (; bytes < last; bytes += 64)
+        __builtin_prefetch(bytes, 0);
+}
+
+void predicate_scan(const scan_predicate_t *predicate, const tuple_t *tuples, size_t begin, size_t end,
+                    predicate_sink_fn sink, void *ctx) {
+    // Room for a full batch plus one more window, which may qualify entirely.
+    tuple_t batch[PREDICATE_BATCH + PREDICATE_WINDOW];
+    size_t filled = 0;
+    for (size_t i = begin; i < end; i += PREDICATE_WINDOW) {
+        size_t count = end - i < PREDICATE_WINDOW ? end - i : PREDICATE_WINDOW;
+        // Requests the input PREDICATE_PREFETCH_WINDOWS windows ahead. The hardware prefetcher
+        // stops at every page boundary and falls behind while a batch is scattered; these loads
+        // keep the memory system busy across both.
+        if (end - i > PREDICATE_PREFETCH_WINDOWS * PREDICATE_WINDOW)
+            prefetch_window(tuples + i + PREDICATE_PREFETCH_WINDOWS * PREDICATE_WINDOW, tuples + end);
+        filled += predicate_select(predicate, tuples + i, count, batch + filled);
+        if (filled >= PREDICATE_BATCH) {
+            sink(ctx, batch, filled);
+            filled = 0;
+        }
+    }
+    if (filled > 0)
+        sink(ctx, batch, filled);
+}
+
+typedef struct {
+    const scan_predicate_t *predicate;
+    const tuple_t *tuples;
+    size_t count;
+    tuple_t *out;
+    int slice_count;
+    size_t *selected;  // Qualifying tuples per slice.
+} filter_ctx_t;
+
+static void filter_slice(int slice, int worker_id, void *void_ctx) {
+    (void)worker_id;
+    filter_ctx_t *ctx = (filter_ctx_t *)void_ctx;
+    size_t per_slice = ctx->count / ctx->slice_count;
+    size_t begin = per_slice * slice;
+    size_t end = slice == ctx->slice_count - 1 ? ctx->count : begin + per_slice;
+    TRACE_BEGIN("filter");
+    ctx->selected[slice] = predicate_select(ctx->predicate, ctx->tuples + begin, end - begin, ctx->out + begin);
+    TRACE_END("filter");
+}
+
+int predicate_filter(const scan_predicate_t *predicate, const tuple_t *tuples, size_t count, tuple_t *out,
+                     int thread_count, size_t *selected_count) {
+    if (thread_count < 1)
+        thread_count = 1;
+    size_t *selected = calloc(thread_count, sizeof(size_t));
+    if (!selected)
+        return -1;
+    // Every slice filters into its own stretch of out; the stretches are then closed up in order.
+    filter_ctx_t ctx = {predicate, tuples, count, out, thread_count, selected};
+    size_t total = 0;
+    int ret = run_tasks(thread_count, thread_count, filter_slice, &ctx);
+    if (ret == 0) {
+        size_t per_slice = count / thread_count;
+        for (int s = 0; s < thread_count; s++) {
+            memmove(out + total, out + per_slice * s, selected[s] * sizeof(tuple_t));
+            total += selected[s];
+        }
+        *selected_count = total;
+    }
+    free(selected);
+    return ret;
+}
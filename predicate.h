@@ -0,0 +1,77 @@
+#ifndef PREDICATE_H
+#define PREDICATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "project.h"
+#include "utils.h"
+
+// Selection predicate pushed into the partitioning pass: a conjunction of an inclusive range on
+// the key and one on the value, both read as integers (load_u64). Comparisons and ranges on
+// either column narrow these bounds, so evaluating a predicate is always two range checks.
+typedef struct scan_predicate {
+    uint64_t key_low, key_high;
+    uint64_t value_low, value_high;
+} scan_predicate_t;
+
+typedef enum {
+    PREDICATE_KEY,
+    PREDICATE_VALUE,
+} predicate_column_t;
+
+typedef enum {
+    PREDICATE_LT,
+    PREDICATE_LE,
+    PREDICATE_GT,
+    PREDICATE_GE,
+    PREDICATE_EQ,
+} predicate_op_t;
+
+// Input tuples compacted per step by the fused kernels, and qualifying tuples gathered before
+// each scatter. Both stay in the L2 cache. A scatter per window moved only a handful of tuples at
+// low selectivities, and the input streamed in between evicted the partition tails each time;
+// scattering full batches writes the partitions as densely as a separate partitioning pass.
+#define PREDICATE_WINDOW 1024
+#define PREDICATE_BATCH 4096
+// How far ahead of the selection the fused loop prefetches its input, in windows.
+#define PREDICATE_PREFETCH_WINDOWS 4
+
+// A predicate every tuple satisfies.
+void predicate_init(scan_predicate_t *predicate);
+
+// ANDs "column op constant" (or low <= column <= high) into predicate. Returns 0 on success, -1
+// when no tuple could qualify any more.
+int predicate_restrict(scan_predicate_t *predicate, predicate_column_t column, predicate_op_t op, uint64_t constant);
+int predicate_restrict_range(scan_predicate_t *predicate, predicate_column_t column, uint64_t low, uint64_t high);
+
+// low <= x <= high as a single unsigned comparison.
+static inline int predicate_in_range(uint64_t x, uint64_t low, uint64_t high) {
+    return x - low <= high - low;
+}
+
+static inline int predicate_match(const scan_predicate_t *predicate, const tuple_t *tuple) {
+    return predicate_in_range(load_u64(tuple->key), predicate->key_low, predicate->key_high) &
+           predicate_in_range(load_u64(tuple->value), predicate->value_low, predicate->value_high);
+}
+
+// Copies the tuples of [tuples, tuples + count) that satisfy predicate to out, in order, and
+// returns how many qualified. Branch-free: every tuple is stored and the output cursor only
+// advances past qualifying ones, so out needs room for count tuples. Evaluates four tuples per
+// step with AVX2 where the CPU has it (checked at run time), one at a time otherwise.
+size_t predicate_select(const scan_predicate_t *predicate, const tuple_t *tuples, size_t count, tuple_t *out);
+
+// Receives a batch of qualifying tuples from predicate_scan.
+typedef void (*predicate_sink_fn)(void *ctx, const tuple_t *tuples, size_t count);
+
+// The fused filter loop: selects the qualifying tuples of [begin, end) window by window into a
+// batch on the stack and hands each full batch, then the remainder, to sink.
+void predicate_scan(const scan_predicate_t *predicate, const tuple_t *tuples, size_t begin, size_t end,
+                    predicate_sink_fn sink, void *ctx);
+
+// Separate filter pass (the materializing baseline): writes the qualifying tuples to out, in
+// input order, with the input split across threads, and their number to selected_count. Returns
+// 0 on success, -1 on allocation failure.
+int predicate_filter(const scan_predicate_t *predicate, const tuple_t *tuples, size_t count, tuple_t *out,
+                     int thread_count, size_t *selected_count);
+
+#endif
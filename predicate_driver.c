@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "partitions.h"
+#include "predicate.h"
+#include "project.h"
+#include "tuples.h"
+#include "utils.h"
+
+#define TUPLE_COUNT (1 << 24)  // ~16 million tuples
+#define DEFAULT_SELECTIVITY 10.0
+// Both sides run this often, alternating, and the median run of each is reported; single runs
+// of either differ by 10-20% on a busy machine.
+#define RUNS 7
+
+// Builds a predicate passing about percent of uniformly random tuples: key < percent% of the key
+// space, or a value range of that width centred in the value space.
+static int build_predicate(scan_predicate_t *predicate, predicate_column_t column, double percent) {
+    predicate_init(predicate);
+    if (percent >= 100.0)
+        return 0;
+    uint64_t width = (uint64_t)(percent / 100.0 * 18446744073709551616.0);
+    if (column == PREDICATE_KEY)
+        return predicate_restrict(predicate, PREDICATE_KEY, PREDICATE_LT, width);
+    if (width == 0)
+        return -1;
+    uint64_t low = (UINT64_MAX - width) / 2;
+    return predicate_restrict_range(predicate, PREDICATE_VALUE, low, low + width - 1);
+}
+
+static int compare_ms(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS> [SELECTIVITY_PERCENT] [key|value] "
+                "[independent|concurrent]\n", argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[1]);
+    int hash_bits = atoi(argv[2]);
+    double selectivity = argc > 3 ? atof(argv[3]) : DEFAULT_SELECTIVITY;
+    const char *column_name = argc > 4 ? argv[4] : "key";
+    strategy_t strategy = STRATEGY_INDEPENDENT;
+    if (argc > 5 && parse_strategy(argv[5], &strategy) != 0) {
+        fprintf(stderr, "Unknown strategy: %s\n", argv[5]);
+        return -1;
+    }
+    predicate_column_t column = strcmp(column_name, "value") == 0 ? PREDICATE_VALUE : PREDICATE_KEY;
+    scan_predicate_t predicate;
+    if ((column == PREDICATE_KEY && strcmp(column_name, "key") != 0) ||
+        build_predicate(&predicate, column, selectivity) != 0) {
+        fprintf(stderr, "Invalid predicate: %s at %.2f%%\n", column_name, selectivity);
+        return -1;
+    }
+
+    tuple_t *tuples = generate_tuples(TUPLE_COUNT);
+    tuple_t *filtered = malloc((size_t)TUPLE_COUNT * sizeof(tuple_t));
+    partition_set_t fused = {0}, separate = {0};
+    int status = -1;
+    if (!tuples || !filtered || partition_set_init(&fused, strategy, TUPLE_COUNT, thread_count, hash_bits) != 0 ||
+        partition_set_init(&separate, strategy, TUPLE_COUNT, thread_count, hash_bits) != 0) {
+        fprintf(stderr, "Error allocating tuples.\n");
+        goto out;
+    }
+    // The filter output and both partition sets are touched beforehand, so that neither side is
+    // billed for first-touch page faults.
+    memset(filtered, 0, (size_t)TUPLE_COUNT * sizeof(tuple_t));
+    partition_set_touch(&fused);
+    partition_set_touch(&separate);
+
+    // Baseline: a separate filter pass materializes the qualifying tuples, which are then partitioned.
+    double filter_runs[RUNS], partition_runs[RUNS], separate_runs[RUNS], fused_runs[RUNS];
+    double throughput;
+    size_t selected;
+    partition_opts_t opts = {.predicate = &predicate};
+    for (int run = 0; run < RUNS; run++) {
+        struct timespec start, filter_end, partition_end, fused_start, fused_end;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+        if (predicate_filter(&predicate, tuples, TUPLE_COUNT, filtered, thread_count, &selected) != 0)
+            goto out;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &filter_end);
+        if (run_strategy_timed(&separate, filtered, selected, thread_count, &throughput, NULL) != 0)
+            goto out;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &partition_end);
+
+        clock_gettime(CLOCK_MONOTONIC_RAW, &fused_start);
+        if (run_strategy_timed(&fused, tuples, TUPLE_COUNT, thread_count, &throughput, &opts) != 0)
+            goto out;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &fused_end);
+
+        filter_runs[run] = elapsed_ms(&start, &filter_end);
+        partition_runs[run] = elapsed_ms(&filter_end, &partition_end);
+        separate_runs[run] = filter_runs[run] + partition_runs[run];
+        fused_runs[run] = elapsed_ms(&fused_start, &fused_end);
+    }
+    qsort(filter_runs, RUNS, sizeof(double), compare_ms);
+    qsort(partition_runs, RUNS, sizeof(double), compare_ms);
+    qsort(separate_runs, RUNS, sizeof(double), compare_ms);
+    qsort(fused_runs, RUNS, sizeof(double), compare_ms);
+
+    for (int p = 0; p < fused.partition_count; p++) {
+        if (partition_set_total(&fused, p) != partition_set_total(&separate, p)) {
+            fprintf(stderr, "Partition %d differs between the fused and the separate run.\n", p);
+            goto out;
+        }
+    }
+
+    // Both throughputs count input tuples, qualifying or not.
+    double filter_ms = filter_runs[RUNS / 2], partition_ms = partition_runs[RUNS / 2];
+    double separate_rate = TUPLE_COUNT / (separate_runs[RUNS / 2] * 1e3);
+    double fused_rate = TUPLE_COUNT / (fused_runs[RUNS / 2] * 1e3);
+    printf("Threads,HashBits,Strategy,Column,Selectivity,Selected,FilterMs,PartitionMs,SeparateMTuples,"
+           "FusedMTuples,Speedup\n");
+    printf("%d,%d,%s,%s,%.2f,%zu,%.2f,%.2f,%.2f,%.2f,%.2f\n", thread_count, hash_bits, strategy_name(strategy),
+           column_name, selectivity, selected, filter_ms, partition_ms, separate_rate, fused_rate,
+           fused_rate / separate_rate);
+    status = 0;
+
+out:
+    partition_set_free(&fused);
+    partition_set_free(&separate);
+    free(filtered);
+    free(tuples);
+    return status;
+}
@@ -1,12 +1,34 @@
 #ifndef PROJECT_H
 #define PROJECT_H
 
+#include <stddef.h>
+
 #define PARTITION_MULTIPLIER 2
-#define MAX_TUPLES (1 << 28)  // Example limit; adjust as needed
+#define MAX_TUPLES ((size_t)1 << 36)  // 1 TiB of tuples; sizes and counts are size_t throughout
 
 typedef struct {
     unsigned char key[8];
     unsigned char value[8];
 } tuple_t;
 
+// Optional features of the partitioning kernels. Passing NULL, or a zeroed struct,
+// selects the plain kernels.
+typedef struct {
+    int prefetch_distance;  // Tuples hashed ahead of their store; 0 disables, -1 auto-tunes.
+    // Per-partition Bloom filters (bloom.h) filled while scattering, one fragment per thread.
+    // They are built by the prefetching kernels, so a distance of 0 selects a default one.
+    struct bloom_set *bloom;
+    // Per-partition counts, key ranges and distinct-key sketches (stats.h), also one fragment
+    // per thread, updated in the scatter loops instead of a pass over the output.
+    struct partition_stats *stats;
+    // Sampled range splitters (range.h): partitions by key range instead of by hash.
+    struct range_splitters *range;
+    // Use the kernels compiled for this fan-out (fanout.h) in the plain scatter loop. Ignored
+    // when prefetching, filters, statistics or range splitters need the generic kernels.
+    int specialized;
+    // Selection predicate (predicate.h): only qualifying tuples are scattered, filtered window by
+    // window inside the partitioning pass.
+    struct scan_predicate *predicate;
+} partition_opts_t;
+
 #endif
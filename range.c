@@ -0,0 +1,145 @@
+#include "range.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// LSD radix sort of count keys, 8 bits per pass; the even number of passes leaves the result in
+// keys. Far faster than qsort for the millions of keys a large sample holds.
+static void sort_keys(uint64_t *keys, uint64_t *scratch, size_t count) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t offsets[256] = {0};
+        for (size_t i = 0; i < count; i++)
+            offsets[(keys[i] >> shift) & 0xFF]++;
+        size_t sum = 0;
+        for (int b = 0; b < 256; b++) {
+            size_t bucket = offsets[b];
+            offsets[b] = sum;
+            sum += bucket;
+        }
+        for (size_t i = 0; i < count; i++)
+            scratch[offsets[(keys[i] >> shift) & 0xFF]++] = keys[i];
+        uint64_t *swap = keys;
+        keys = scratch;
+        scratch = swap;
+    }
+}
+
+// Fills samples with sample_count keys drawn with replacement, or with every key when the sample
+// would be as large as the input.
+static void draw_sample(uint64_t *samples, size_t sample_count, const tuple_t *tuples, size_t tuple_count,
+                        uint64_t state) {
+    for (size_t i = 0; i < sample_count; i++) {
+        size_t t = i;
+        if (sample_count < tuple_count) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            t = state % tuple_count;
+        }
+        samples[i] = load_u64(tuples[t].key);
+    }
+}
+
+// Index of the first of the count sorted keys that is at least key.
+static size_t lower_bound(const uint64_t *keys, size_t count, uint64_t key) {
+    size_t low = 0, high = count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (keys[mid] < key)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+// Fills the Eytzinger tree by an in-order walk, which visits its nodes in sorted order.
+static size_t fill_tree(uint64_t *tree, size_t node, size_t node_count, const uint64_t *sorted, size_t next) {
+    if (node > node_count)
+        return next;
+    next = fill_tree(tree, 2 * node, node_count, sorted, next);
+    tree[node] = sorted[next++];
+    return fill_tree(tree, 2 * node + 1, node_count, sorted, next);
+}
+
+int range_splitters_build(range_splitters_t *range, const tuple_t *tuples, size_t tuple_count, int hash_bits) {
+    memset(range, 0, sizeof(*range));
+    if (!tuples || tuple_count == 0 || hash_bits < 0 || hash_bits > 24)
+        return -1;
+
+    int partition_count = 1 << hash_bits;
+    size_t sample_count = (size_t)partition_count * RANGE_SAMPLES_PER_PARTITION;
+    if (sample_count > tuple_count)
+        sample_count = tuple_count;
+    uint64_t *samples = malloc(sample_count * sizeof(uint64_t));
+    uint64_t *scratch = malloc(sample_count * sizeof(uint64_t));
+    uint64_t *splitters = malloc(partition_count * sizeof(uint64_t));
+    size_t *histogram = calloc(partition_count, sizeof(size_t));
+    range->tree = aligned_alloc(64, ((partition_count * sizeof(uint64_t) + 63) / 64) * 64);
+    if (!samples || !scratch || !splitters || !histogram || !range->tree) {
+        free(samples);
+        free(scratch);
+        free(splitters);
+        free(histogram);
+        range_splitters_free(range);
+        return -1;
+    }
+
+    // Take evenly spaced quantiles of the sample as splitters.
+    draw_sample(samples, sample_count, tuples, tuple_count, 0x9E3779B97F4A7C15ULL ^ tuple_count);
+    sort_keys(samples, scratch, sample_count);
+    for (int p = 1; p < partition_count; p++)
+        splitters[p - 1] = samples[(size_t)p * sample_count / partition_count];
+
+    range->partition_count = partition_count;
+    range->levels = hash_bits;
+    range->tree[0] = 0;
+    fill_tree(range->tree, 1, (size_t)partition_count - 1, splitters, 0);
+
+    // Histogram of a second, independent sample over the splitters. The sample the splitters were
+    // cut from puts exactly sample_count / partition_count keys into every partition of distinct
+    // keys, so it would only see runs of equal keys: those collapse several splitters into one,
+    // leaving the partitions between them empty and the last one holding the run. A fresh sample
+    // also sees where the splitters are off through sampling error; three standard deviations
+    // of its count are added on top. A sample of every key gives exact sizes instead, read off
+    // the sorted keys: partition p holds those from the first reaching splitter p - 1 up to the
+    // first reaching splitter p.
+    size_t fullest = 0;
+    if (sample_count == tuple_count) {
+        size_t begin = 0;
+        for (int p = 0; p < partition_count; p++) {
+            size_t end = p < partition_count - 1 ? lower_bound(samples, sample_count, splitters[p]) : sample_count;
+            if (end - begin > fullest)
+                fullest = end - begin;
+            begin = end;
+        }
+    } else {
+        draw_sample(samples, sample_count, tuples, tuple_count, 0xD1B54A32D192ED03ULL ^ tuple_count);
+        for (size_t i = 0; i < sample_count; i++) {
+            int p = range_partition(range, (const unsigned char *)&samples[i]);
+            if (++histogram[p] > fullest)
+                fullest = histogram[p];
+        }
+    }
+    double bound = sample_count < tuple_count ? fullest + 3.0 * sqrt((double)fullest) + 1.0 : (double)fullest;
+    range->largest = (size_t)ceil(bound * tuple_count / sample_count);
+    free(samples);
+    free(scratch);
+    free(splitters);
+    free(histogram);
+    return 0;
+}
+
+void range_splitters_free(range_splitters_t *range) {
+    free(range->tree);
+    range->tree = NULL;
+}
+
+uint64_t range_upper_bound(const range_splitters_t *range, int partition) {
+    // Leaf index partition_count + p; the nearest ancestor reached through a left child holds
+    // the smallest splitter above the partition.
+    size_t i = (size_t)range->partition_count + partition;
+    while (i > 1 && (i & 1))
+        i >>= 1;
+    return i > 1 ? range->tree[i >> 1] : UINT64_MAX;
+}
@@ -0,0 +1,45 @@
+#ifndef RANGE_H
+#define RANGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "project.h"
+#include "utils.h"
+
+// Range partitioning on the key read as an integer (load_u64): partition p holds the keys in
+// [splitter p - 1, splitter p). The partition_count - 1 splitters are stored in Eytzinger
+// (breadth-first) order, so the search walks down a cache-friendly implicit tree with one
+// comparison per level and no data-dependent branches.
+typedef struct range_splitters {
+    int partition_count;
+    int levels;                 // log2(partition_count).
+    uint64_t *tree;             // tree[1 .. partition_count - 1]; tree[0] is unused.
+    size_t largest;             // Upper estimate of the tuples in the fullest partition.
+} range_splitters_t;
+
+// Picks balanced splitters for 2^hash_bits partitions from a random sample of the input (about
+// RANGE_SAMPLES_PER_PARTITION keys per partition). Once that covers the input every key is used
+// and the splitters are exact quantiles. Returns 0 on success, -1 on invalid arguments or
+// allocation failure.
+// A key repeated more often than the mean partition size cannot be split across partitions,
+// so its partition outgrows buffers sized for the mean (partition_set_init) and the kernels
+// drop the excess. largest bounds that partition's size: exact when every key was used,
+// otherwise measured on a second, independent sample plus three standard deviations of
+// sampling error. Callers with fixed buffers size them from it, at the cost of memory in
+// proportion to largest over the mean for every buffer.
+#define RANGE_SAMPLES_PER_PARTITION 16384
+int range_splitters_build(range_splitters_t *range, const tuple_t *tuples, size_t tuple_count, int hash_bits);
+void range_splitters_free(range_splitters_t *range);
+
+// Upper bound of partition p (exclusive), or UINT64_MAX for the last partition.
+uint64_t range_upper_bound(const range_splitters_t *range, int partition);
+
+static inline int range_partition(const range_splitters_t *range, const unsigned char *key) {
+    uint64_t k = load_u64(key);
+    size_t i = 1;
+    for (int level = 0; level < range->levels; level++)
+        i = 2 * i + (k >= range->tree[i]);
+    return (int)(i - (size_t)range->partition_count);
+}
+
+#endif
@@ -0,0 +1,174 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "partitions.h"
+#include "project.h"
+#include "range.h"
+#include "tuples.h"
+#include "utils.h"
+
+#define TUPLE_COUNT (1 << 24)  // ~16 million tuples
+
+static uint64_t xorshift64(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Skewed keys: a random 64-bit value shifted right by a random 0..47 bits, so key magnitudes are
+// spread over many orders of magnitude and most keys sit close to zero.
+static void skew_keys(tuple_t *tuples, size_t tuple_count) {
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (size_t i = 0; i < tuple_count; i++) {
+        uint64_t r = xorshift64(&state);
+        uint64_t key = r >> (xorshift64(&state) % 48);
+        memcpy(tuples[i].key, &key, sizeof(key));
+    }
+}
+
+// Largest partition over the mean partition size (1.0 is a perfect balance).
+static double imbalance(const size_t *counts, int partition_count, size_t tuple_count) {
+    size_t largest = 0;
+    for (int p = 0; p < partition_count; p++)
+        if (counts[p] > largest)
+            largest = counts[p];
+    return largest * (double)partition_count / (double)tuple_count;
+}
+
+static double set_imbalance(const partition_set_t *set, size_t *counts, size_t tuple_count) {
+    for (int p = 0; p < set->partition_count; p++)
+        counts[p] = partition_set_total(set, p);
+    return imbalance(counts, set->partition_count, tuple_count);
+}
+
+// Checks that every tuple of the range-partitioned set lies inside its partition's key range.
+static int check_ranges(const partition_set_t *set, const range_splitters_t *range) {
+    for (int p = 0; p < set->partition_count; p++) {
+        uint64_t low = p > 0 ? range_upper_bound(range, p - 1) : 0;
+        uint64_t high = range_upper_bound(range, p);
+        for (int f = 0; f < set->fragment_count; f++) {
+            const tuple_t *buffer = set->buffers[f * set->partition_count + p];
+            size_t size = set->sizes[f * set->partition_count + p];
+            for (size_t i = 0; i < size; i++) {
+                uint64_t key = load_u64(buffer[i].key);
+                if (key < low || (high != UINT64_MAX && key >= high)) {
+                    fprintf(stderr, "Key %llu is outside partition %d.\n", (unsigned long long)key, p);
+                    return -1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Tuples the set holds; any shortfall was dropped on partition overflow.
+static size_t set_total(const partition_set_t *set) {
+    size_t total = 0;
+    for (int p = 0; p < set->partition_count; p++)
+        total += partition_set_total(set, p);
+    return total;
+}
+
+// Reference: partitions of equal key width between the smallest and largest key, which is what
+// range partitioning without sampling would give.
+static double equal_width_imbalance(const tuple_t *tuples, size_t tuple_count, size_t *counts, int partition_count) {
+    uint64_t low = UINT64_MAX, high = 0;
+    for (size_t i = 0; i < tuple_count; i++) {
+        uint64_t key = load_u64(tuples[i].key);
+        low = key < low ? key : low;
+        high = key > high ? key : high;
+    }
+    uint64_t width = (high - low) / (uint64_t)partition_count + 1;
+    memset(counts, 0, partition_count * sizeof(size_t));
+    for (size_t i = 0; i < tuple_count; i++)
+        counts[(load_u64(tuples[i].key) - low) / width]++;
+    return imbalance(counts, partition_count, tuple_count);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS> [independent|concurrent] [uniform|skewed]\n", argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[1]);
+    int hash_bits = atoi(argv[2]);
+    strategy_t strategy = STRATEGY_INDEPENDENT;
+    if (argc > 3 && parse_strategy(argv[3], &strategy) != 0) {
+        fprintf(stderr, "Unknown strategy: %s\n", argv[3]);
+        return -1;
+    }
+    const char *distribution = argc > 4 ? argv[4] : "uniform";
+    int skewed = strcmp(distribution, "skewed") == 0;
+    if (!skewed && strcmp(distribution, "uniform") != 0) {
+        fprintf(stderr, "Unknown distribution: %s\n", distribution);
+        return -1;
+    }
+
+    tuple_t *tuples = generate_tuples(TUPLE_COUNT);
+    size_t *counts = malloc(((size_t)1 << hash_bits) * sizeof(size_t));
+    if (!tuples || !counts) {
+        fprintf(stderr, "Error generating tuples.\n");
+        free(tuples);
+        free(counts);
+        return -1;
+    }
+    if (skewed)
+        skew_keys(tuples, TUPLE_COUNT);
+
+    // The splitters are picked once, before the timed runs, as a planner would.
+    range_splitters_t range;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    int built = range_splitters_build(&range, tuples, TUPLE_COUNT, hash_bits);
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+    if (built != 0) {
+        fprintf(stderr, "Error building range splitters.\n");
+        free(tuples);
+        free(counts);
+        return -1;
+    }
+
+    // partition_set_init sizes buffers for the mean partition; the range set is sized for the
+    // fullest one the sample predicts, so that runs of duplicate keys fit (see range.h).
+    size_t range_sizing = TUPLE_COUNT;
+    if (range.largest > TUPLE_COUNT >> hash_bits)
+        range_sizing = range.largest << hash_bits;
+    partition_set_t hash_set = {0}, range_set = {0};
+    double hash_throughput, range_throughput, hash_imbalance, range_imbalance;
+    partition_opts_t opts = {.range = &range};
+    int status = -1;
+    if (partition_set_init(&hash_set, strategy, TUPLE_COUNT, thread_count, hash_bits) != 0 ||
+        partition_set_init(&range_set, strategy, range_sizing, thread_count, hash_bits) != 0)
+        goto out;
+    partition_set_touch(&hash_set);
+    partition_set_touch(&range_set);
+    if (run_strategy_timed(&hash_set, tuples, TUPLE_COUNT, thread_count, &hash_throughput, NULL) != 0)
+        goto out;
+    hash_imbalance = set_imbalance(&hash_set, counts, TUPLE_COUNT);
+    if (run_strategy_timed(&range_set, tuples, TUPLE_COUNT, thread_count, &range_throughput, &opts) != 0 ||
+        check_ranges(&range_set, &range) != 0)
+        goto out;
+    if (set_total(&range_set) != TUPLE_COUNT) {
+        fprintf(stderr, "Range partitions hold %zu of %d tuples.\n", set_total(&range_set), TUPLE_COUNT);
+        goto out;
+    }
+    range_imbalance = set_imbalance(&range_set, counts, TUPLE_COUNT);
+
+    printf("Threads,HashBits,Strategy,Distribution,SampleMs,HashMTuples,RangeMTuples,"
+           "HashImbalance,RangeImbalance,EqualWidthImbalance\n");
+    printf("%d,%d,%s,%s,%.2f,%.2f,%.2f,%.3f,%.3f,%.3f\n", thread_count, hash_bits, strategy_name(strategy),
+           distribution, elapsed_ms(&start, &end), hash_throughput, range_throughput, hash_imbalance,
+           range_imbalance, equal_width_imbalance(tuples, TUPLE_COUNT, counts, range_set.partition_count));
+    status = 0;
+
+out:
+    partition_set_free(&hash_set);
+    partition_set_free(&range_set);
+    range_splitters_free(&range);
+    free(tuples);
+    free(counts);
+    return status;
+}
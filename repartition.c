@@ -0,0 +1,114 @@
+#include "project.h"
+#include "utils.h"
+#include "tasks.h"
+#include "partitions.h"
+#include "repartition.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const partition_set_t *src;
+    partition_set_t *dst;
+    int extra_bits;
+    size_t *src_offsets;  // Start of each source partition's children in dst->block.
+    size_t *counts;       // Per-worker child histograms (2^extra_bits entries each).
+    tuple_t **cursors;  // Per-worker child write cursors.
+} refine_ctx_t;
+
+static void refine_partition(int partition, int worker_id, void *void_ctx) {
+    refine_ctx_t *ctx = (refine_ctx_t *)void_ctx;
+    const partition_set_t *src = ctx->src;
+    partition_set_t *dst = ctx->dst;
+    int b = src->hash_bits;
+    int children = 1 << ctx->extra_bits;
+    uint32_t child_mask = children - 1;
+    size_t *counts = ctx->counts + (size_t)worker_id * children;
+    tuple_t **cursors = ctx->cursors + (size_t)worker_id * children;
+
+    // Histogram of the child ids.
+    memset(counts, 0, children * sizeof(size_t));
+    for (int f = 0; f < src->fragment_count; f++) {
+        size_t slot = (size_t)f * src->partition_count + partition;
+        const tuple_t *fragment = src->buffers[slot];
+        for (size_t j = 0; j < src->sizes[slot]; j++)
+            counts[(hash_key(fragment[j].key) >> b) & child_mask]++;
+    }
+
+    // Child j of partition p is partition p | (j << b) at the finer fan-out.
+    tuple_t *out = dst->block + ctx->src_offsets[partition];
+    for (int c = 0; c < children; c++) {
+        int child = partition | (c << b);
+        dst->buffers[child] = out;
+        dst->sizes[child] = counts[c];
+        cursors[c] = out;
+        out += counts[c];
+    }
+
+    for (int f = 0; f < src->fragment_count; f++) {
+        size_t slot = (size_t)f * src->partition_count + partition;
+        const tuple_t *fragment = src->buffers[slot];
+        for (size_t j = 0; j < src->sizes[slot]; j++)
+            *cursors[(hash_key(fragment[j].key) >> b) & child_mask]++ = fragment[j];
+    }
+}
+
+int refine_partitions(const partition_set_t *src, int extra_bits, int thread_count, partition_set_t *dst) {
+    if (!src || !dst || extra_bits < 0 || src->hash_bits + extra_bits > 30)
+        return -1;
+
+    memset(dst, 0, sizeof(*dst));
+    dst->strategy = STRATEGY_CONCURRENT;
+    dst->hash_bits = src->hash_bits + extra_bits;
+    dst->partition_count = 1 << dst->hash_bits;
+    dst->fragment_count = 1;
+    dst->capacity = 0;  // Packed back to back; sizes are exact.
+
+    size_t *src_offsets = malloc((src->partition_count + 1) * sizeof(size_t));
+    if (!src_offsets)
+        return -1;
+    src_offsets[0] = 0;
+    for (int p = 0; p < src->partition_count; p++)
+        src_offsets[p + 1] = src_offsets[p] + partition_set_total(src, p);
+
+    size_t total = src_offsets[src->partition_count];
+    size_t children = (size_t)1 << extra_bits;
+    refine_ctx_t ctx = {
+        .src = src,
+        .dst = dst,
+        .extra_bits = extra_bits,
+        .src_offsets = src_offsets,
+        .counts = malloc(thread_count * children * sizeof(size_t)),
+        .cursors = malloc(thread_count * children * sizeof(tuple_t *)),
+    };
+    dst->block = malloc((total > 0 ? total : 1) * sizeof(tuple_t));
+    dst->buffers = malloc(dst->partition_count * sizeof(tuple_t *));
+    dst->sizes = calloc(dst->partition_count, sizeof(size_t));
+    int ret = -1;
+    if (!dst->block || !dst->buffers || !dst->sizes || !ctx.counts || !ctx.cursors)
+        fprintf(stderr, "Error allocating refined partitions.\n");
+    else
+        ret = run_tasks(thread_count, src->partition_count, refine_partition, &ctx);
+
+    free(ctx.counts);
+    free(ctx.cursors);
+    free(src_offsets);
+    if (ret != 0)
+        partition_set_free(dst);
+    return ret;
+}
+
+int coalesce_partitions(const partition_set_t *src, int fewer_bits, partition_set_t *dst) {
+    if (!src || !dst || fewer_bits < 0 || fewer_bits > src->hash_bits)
+        return -1;
+
+    // Fine partition p | (j << (b - k)) becomes fragment f * 2^k + j of coarse partition p. With
+    // buffers laid out as [fragment][partition], that is the very same slot, so the view is the
+    // source arrays read with a smaller partition count and more fragments.
+    *dst = *src;
+    dst->hash_bits = src->hash_bits - fewer_bits;
+    dst->partition_count = src->partition_count >> fewer_bits;
+    dst->fragment_count = src->fragment_count << fewer_bits;
+    dst->view = 1;
+    return 0;
+}
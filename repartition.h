@@ -0,0 +1,18 @@
+#ifndef REPARTITION_H
+#define REPARTITION_H
+
+#include "partitions.h"
+
+// Splits every partition of src (hash_bits b) into 2^extra_bits partitions on the next k hash bits,
+// so that dst holds exactly the partitions hash_to_partition produces at b + extra_bits bits.
+// Each source partition is split by one task (histogram, then scatter) while it is cache-resident.
+// dst is allocated here as a single packed fragment; release it with partition_set_free.
+int refine_partitions(const partition_set_t *src, int extra_bits, int thread_count, partition_set_t *dst);
+
+// The reverse direction: presents src (hash_bits b) as 2^(b - fewer_bits) partitions, each made
+// of the 2^fewer_bits source partitions sharing its low hash bits, without moving or copying
+// tuples. dst is a view of src's buffers (partition_set_t.view): it stays valid only as long as
+// src does and is not partitioned into; partition_set_free on it is a no-op.
+int coalesce_partitions(const partition_set_t *src, int fewer_bits, partition_set_t *dst);
+
+#endif
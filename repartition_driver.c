@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "partitions.h"
+#include "project.h"
+#include "repartition.h"
+#include "tuples.h"
+#include "utils.h"
+
+#define TUPLE_COUNT (1 << 24)  // ~16 million tuples
+#define DEFAULT_EXTRA_BITS 4
+
+// Checks that every tuple of set sits in its hash partition and that the partition sizes match
+// reference (a run at the same fan-out). Returns 0 when they do.
+static int check_partitions(const partition_set_t *set, const partition_set_t *reference) {
+    for (int p = 0; p < set->partition_count; p++) {
+        if (partition_set_total(set, p) != partition_set_total(reference, p)) {
+            fprintf(stderr, "Partition %d holds %zu tuples instead of %zu.\n", p, partition_set_total(set, p),
+                    partition_set_total(reference, p));
+            return -1;
+        }
+        for (int f = 0; f < set->fragment_count; f++) {
+            size_t slot = (size_t)f * set->partition_count + p;
+            for (size_t i = 0; i < set->sizes[slot]; i++) {
+                if (hash_to_partition(set->buffers[slot][i].key, set->partition_count) != p) {
+                    fprintf(stderr, "Tuple %zu of partition %d does not belong there.\n", i, p);
+                    return -1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static double mtuples_per_sec(const struct timespec *start, const struct timespec *end) {
+    return TUPLE_COUNT / (elapsed_ms(start, end) * 1e3);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS> [EXTRA_BITS]\n", argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[1]);
+    int hash_bits = atoi(argv[2]);
+    int extra_bits = argc > 3 ? atoi(argv[3]) : DEFAULT_EXTRA_BITS;
+    if (extra_bits < 0 || hash_bits < 0 || hash_bits + extra_bits > 24) {
+        fprintf(stderr, "HASHBITS + EXTRA_BITS must be at most 24.\n");
+        return -1;
+    }
+
+    tuple_t *tuples = generate_tuples(TUPLE_COUNT);
+    if (!tuples) {
+        fprintf(stderr, "Error generating tuples.\n");
+        return -1;
+    }
+
+    // The existing output at HASHBITS, then the two ways to reach HASHBITS + EXTRA_BITS: refining
+    // it, or partitioning the raw tuples again.
+    partition_set_t coarse = {0}, refined = {0}, scratch = {0}, coalesced = {0};
+    struct timespec start, refine_end, scratch_start, scratch_end, coalesce_start, coalesce_end;
+    double throughput;
+    int status = -1;
+    if (partition_set_init(&coarse, STRATEGY_INDEPENDENT, TUPLE_COUNT, thread_count, hash_bits) != 0 ||
+        partition_set_init(&scratch, STRATEGY_INDEPENDENT, TUPLE_COUNT, thread_count, hash_bits + extra_bits) != 0 ||
+        run_strategy_timed(&coarse, tuples, TUPLE_COUNT, thread_count, &throughput, NULL) != 0) {
+        fprintf(stderr, "Error partitioning tuples.\n");
+        goto out;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    if (refine_partitions(&coarse, extra_bits, thread_count, &refined) != 0)
+        goto out;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &refine_end);
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &scratch_start);
+    if (run_strategy_timed(&scratch, tuples, TUPLE_COUNT, thread_count, &throughput, NULL) != 0)
+        goto out;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &scratch_end);
+
+    // Coalescing the from-scratch output back down must give the coarse partitions, in place.
+    clock_gettime(CLOCK_MONOTONIC_RAW, &coalesce_start);
+    if (coalesce_partitions(&scratch, extra_bits, &coalesced) != 0)
+        goto out;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &coalesce_end);
+
+    if (check_partitions(&refined, &scratch) != 0 || check_partitions(&coalesced, &coarse) != 0)
+        goto out;
+
+    double refine_rate = mtuples_per_sec(&start, &refine_end);
+    double scratch_rate = mtuples_per_sec(&scratch_start, &scratch_end);
+    printf("Threads,HashBits,ExtraBits,RefineMTuples,ScratchMTuples,Speedup,CoalesceUs\n");
+    printf("%d,%d,%d,%.2f,%.2f,%.2f,%.3f\n", thread_count, hash_bits, extra_bits, refine_rate, scratch_rate,
+           refine_rate / scratch_rate, elapsed_ms(&coalesce_start, &coalesce_end) * 1000.0);
+    status = 0;
+
+out:
+    partition_set_free(&coalesced);
+    partition_set_free(&refined);
+    partition_set_free(&scratch);
+    partition_set_free(&coarse);
+    free(tuples);
+    return status;
+}
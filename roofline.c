@@ -0,0 +1,168 @@
+#define _GNU_SOURCE
+#include "project.h"
+#include "utils.h"
+#include "affinity.h"
+#include "roofline.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    const tuple_t *tuples;
+    size_t tuple_count;
+    int thread_count;
+    int partition_count;
+    size_t capacity;        // Tuples per stream (ROOFLINE_SCATTER).
+    tuple_t *out;
+    roofline_kind_t kind;
+    double *thread_ms;
+    uint64_t *sinks;        // Per-thread read checksums, so the reads are not optimized away.
+} roofline_ctx_t;
+
+typedef struct {
+    roofline_ctx_t *ctx;
+    int thread_id;          // 0-based slice index; pinned like the partitioners' thread_id + 1.
+} roofline_thread_t;
+
+static const char *kind_names[] = {"read", "write", "scatter"};
+
+int parse_roofline_kind(const char *name, roofline_kind_t *kind) {
+    for (int i = 0; i < 3; i++) {
+        if (strcmp(name, kind_names[i]) == 0) {
+            *kind = (roofline_kind_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *roofline_kind_name(roofline_kind_t kind) {
+    return kind_names[kind];
+}
+
+static uint64_t read_slice(const tuple_t *tuples, size_t begin, size_t end) {
+    uint64_t sum = 0;
+    for (size_t i = begin; i < end; i++)
+        sum += load_u64(tuples[i].key) ^ load_u64(tuples[i].value);
+    return sum;
+}
+
+static void write_slice(tuple_t *out, size_t begin, size_t end, int thread_id) {
+    tuple_t tuple;
+    memset(&tuple, thread_id, sizeof(tuple));
+    for (size_t i = begin; i < end; i++)
+        out[i] = tuple;
+}
+
+// The stream index comes from a xorshift generator rather than a hash of the key, so the
+// kernel pays for the scattered stores but not for hashing.
+static void scatter_slice(const roofline_ctx_t *ctx, int thread_id, size_t begin, size_t end) {
+    int partition_count = ctx->partition_count;
+    tuple_t *base = ctx->out + (size_t)thread_id * partition_count * ctx->capacity;
+    size_t sizes[partition_count];
+    memset(sizes, 0, sizeof(sizes));
+    uint64_t state = 0x9E3779B97F4A7C15ULL ^ (uint64_t)(thread_id + 1);
+    uint32_t mask = partition_count - 1;
+    for (size_t i = begin; i < end; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int p = (int)(state & mask);
+        size_t idx = sizes[p];
+        if (idx >= ctx->capacity)
+            continue;
+        base[(size_t)p * ctx->capacity + idx] = ctx->tuples[i];
+        sizes[p] = idx + 1;
+    }
+}
+
+static void *run_kernel(void *void_args) {
+    roofline_thread_t *args = (roofline_thread_t *)void_args;
+    roofline_ctx_t *ctx = args->ctx;
+    int task_id = args->thread_id;
+    set_affinity(task_id + 1);
+
+    size_t base = ctx->tuple_count / ctx->thread_count;
+    size_t begin = (size_t)task_id * base;
+    size_t end = task_id == ctx->thread_count - 1 ? ctx->tuple_count : begin + base;
+
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    switch (ctx->kind) {
+    case ROOFLINE_READ:
+        ctx->sinks[task_id] = read_slice(ctx->tuples, begin, end);
+        break;
+    case ROOFLINE_WRITE:
+        write_slice(ctx->out, begin, end, task_id);
+        break;
+    case ROOFLINE_SCATTER:
+        scatter_slice(ctx, task_id, begin, end);
+        break;
+    }
+    clock_gettime(CLOCK_MONOTONIC_RAW, &stop);
+    ctx->thread_ms[task_id] = elapsed_ms(&start, &stop);
+    return NULL;
+}
+
+int run_roofline_timed(const tuple_t *tuples, size_t tuple_count, int thread_count, int hash_bits,
+                       roofline_kind_t kind, double *throughput) {
+    if (!tuples || !throughput || thread_count <= 0 || hash_bits < 0)
+        return -1;
+
+    roofline_ctx_t ctx = {
+        .tuples = tuples,
+        .tuple_count = tuple_count,
+        .thread_count = thread_count,
+        .partition_count = 1 << hash_bits,
+        .kind = kind,
+    };
+    // Outputs are allocated like the partitioners' buffers, so first-touch page faults count too.
+    size_t out_tuples = 0;
+    if (kind == ROOFLINE_WRITE) {
+        out_tuples = tuple_count;
+    } else if (kind == ROOFLINE_SCATTER) {
+        ctx.capacity = (tuple_count / ctx.partition_count) * PARTITION_MULTIPLIER;
+        out_tuples = (size_t)thread_count * ctx.partition_count * ctx.capacity;
+    }
+    ctx.out = out_tuples ? malloc(out_tuples * sizeof(tuple_t)) : NULL;
+    ctx.thread_ms = calloc(thread_count, sizeof(double));
+    ctx.sinks = calloc(thread_count, sizeof(uint64_t));
+    pthread_t *threads = malloc(thread_count * sizeof(pthread_t));
+    roofline_thread_t *args = malloc(thread_count * sizeof(roofline_thread_t));
+    int ret = -1;
+    if ((out_tuples && !ctx.out) || !ctx.thread_ms || !ctx.sinks || !threads || !args) {
+        fprintf(stderr, "Error allocating roofline buffers.\n");
+        goto out;
+    }
+
+    // One pinned thread per slice, so each thread times exactly its own slice on its own core.
+    for (int i = 0; i < thread_count; i++) {
+        args[i] = (roofline_thread_t){.ctx = &ctx, .thread_id = i};
+        if (pthread_create(&threads[i], NULL, run_kernel, &args[i]) != 0) {
+            fprintf(stderr, "Error creating thread %d\n", i);
+            for (int j = 0; j < i; j++)
+                pthread_join(threads[j], NULL);
+            goto out;
+        }
+    }
+    for (int i = 0; i < thread_count; i++)
+        pthread_join(threads[i], NULL);
+
+    double total_ms = 0.0;
+    for (int i = 0; i < thread_count; i++)
+        total_ms += ctx.thread_ms[i];
+    double avg_time_sec = total_ms / thread_count / 1000.0;
+    *throughput = ((double)tuple_count / avg_time_sec) / 1e6;  // Throughput in millions of tuples/sec
+    ret = 0;
+
+out:
+    free(ctx.out);
+    free(ctx.thread_ms);
+    free(ctx.sinks);
+    free(threads);
+    free(args);
+    return ret;
+}
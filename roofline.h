@@ -0,0 +1,26 @@
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+#include "project.h"
+
+// Memory ceilings for the partitioners, measured with the same threads, affinity and output
+// allocation. Throughputs are in million 16-byte tuples per second, like the partitioners
+// report, so they can be compared directly.
+typedef enum {
+    ROOFLINE_READ,     // Sequential read of the input.
+    ROOFLINE_WRITE,    // Sequential stores into a freshly allocated output.
+    ROOFLINE_SCATTER,  // Sequential read plus stores to 2^hash_bits output streams picked at random.
+} roofline_kind_t;
+
+// Parses "read" / "write" / "scatter". Returns 0 on success, -1 on unknown names.
+int parse_roofline_kind(const char *name, roofline_kind_t *kind);
+const char *roofline_kind_name(roofline_kind_t kind);
+
+// Runs one kernel over tuple_count tuples on thread_count pinned threads, one slice each.
+// hash_bits only affects ROOFLINE_SCATTER, whose streams are per-thread buffers laid out like
+// the independent strategy's. Throughput uses the average per-thread time, like
+// run_independent_timed.
+int run_roofline_timed(const tuple_t *tuples, size_t tuple_count, int thread_count, int hash_bits,
+                       roofline_kind_t kind, double *throughput);
+
+#endif
@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "roofline.h"
+#include "project.h"
+#include "utils.h"
+#include "tuples.h"
+
+#define DEFAULT_TUPLE_COUNT ((size_t)1 << 24)  // ~16 million tuples; -n overrides it
+
+int main(int argc, char *argv[]) {
+    const char *usage = "Usage: %s [-n LOG2_TUPLES] <THREAD_COUNT> <HASHBITS> [read|write|scatter]\n";
+    size_t tuple_count = DEFAULT_TUPLE_COUNT;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        switch (opt) {
+        case 'n':
+            if (parse_log2_tuples(optarg, &tuple_count) != 0) {
+                fprintf(stderr, "Invalid LOG2_TUPLES '%s'.\n", optarg);
+                return -1;
+            }
+            break;
+        default:
+            fprintf(stderr, usage, argv[0]);
+            return -1;
+        }
+    }
+    if (argc - optind < 2) {
+        fprintf(stderr, usage, argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[optind]);
+    int hash_bits = atoi(argv[optind + 1]);
+    roofline_kind_t kind = ROOFLINE_SCATTER;
+    if (argc - optind > 2 && parse_roofline_kind(argv[optind + 2], &kind) != 0) {
+        fprintf(stderr, "Unknown kernel '%s'.\n", argv[optind + 2]);
+        return -1;
+    }
+
+    // Generate tuples.
+    tuple_t *tuples = generate_tuples(tuple_count);
+    if (!tuples) {
+        fprintf(stderr, "Error generating tuples.\n");
+        return -1;
+    }
+
+    // Run experiment.
+    double throughput = 0.0;
+    if (run_roofline_timed(tuples, tuple_count, thread_count, hash_bits, kind, &throughput) != 0) {
+        fprintf(stderr, "Error in %s roofline with %d threads and %d hashbits\n", roofline_kind_name(kind),
+                thread_count, hash_bits);
+    } else {
+        // Same CSV as the partitioners; the bandwidth goes to stderr.
+        printf("Threads,HashBits,Throughput\n");
+        printf("%d,%d,%.2f\n", thread_count, hash_bits, throughput);
+        fprintf(stderr, "%s: %.2f GB/s\n", roofline_kind_name(kind), throughput * sizeof(tuple_t) / 1e3);
+    }
+
+    free(tuples);
+    return 0;
+}
@@ -0,0 +1,246 @@
+#include "project.h"
+#include "utils.h"
+#include "scatter.h"
+#include "bloom.h"
+#include "stats.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TUNE_SAMPLE (1 << 18)
+
+// 0 stands for the plain, unpipelined loop, which wins at low fan-outs.
+static const int tune_distances[] = {0, 2, 4, 8, 16, 32, 64, 128};
+
+// Rounds up to a power of two in [2, MAX_PREFETCH_DISTANCE] so window slots are found with a mask.
+static inline int clamp_distance(int distance) {
+    int rounded = 2;
+    while (rounded < distance && rounded < MAX_PREFETCH_DISTANCE)
+        rounded <<= 1;
+    return rounded;
+}
+
+// Filter block of tuple s when building Bloom filters: computed and prefetched at hash time,
+// filled at store time. Its ring spans two distances, since tuple s - distance is stored in the
+// same step that hashes tuple s.
+static inline void bloom_prefetch(bloom_set_t *bloom, bloom_block_t *filters, const tuple_t *tuple, int p,
+                                  bloom_block_t **blocks, uint64_t *hashes, size_t s, int mask) {
+    uint64_t h = bloom_hash(tuple->key);
+    bloom_block_t *block = bloom_block(filters + (size_t)p * (bloom->block_mask + 1), bloom->block_mask, h);
+    blocks[s & mask] = block;
+    hashes[s & mask] = h;
+    __builtin_prefetch(block, 1);
+}
+
+void scatter_independent_prefetch(const tuple_t *tuples, size_t begin, size_t end, int partition_count,
+                                  tuple_t **buffers, size_t *sizes, size_t capacity, int distance, int thread_id,
+                                  const partition_opts_t *opts) {
+    int partitions[MAX_PREFETCH_DISTANCE];
+    uint32_t partition_hashes[MAX_PREFETCH_DISTANCE];
+    tuple_t *slots[MAX_PREFETCH_DISTANCE];
+    bloom_block_t *blocks[2 * MAX_PREFETCH_DISTANCE];
+    uint64_t hashes[2 * MAX_PREFETCH_DISTANCE];
+    bloom_set_t *bloom = opts ? opts->bloom : NULL;
+    partition_stats_t *stats = opts ? opts->stats : NULL;
+    const range_splitters_t *range = opts ? opts->range : NULL;
+    stats_fragment_t stats_view = stats ? partition_stats_fragment(stats, thread_id - 1) : (stats_fragment_t){0};
+    bloom_block_t *filters = bloom ? bloom_filter(bloom, thread_id - 1, 0) : NULL;
+    distance = clamp_distance(distance);
+    int half = distance / 2;
+    int mask = distance - 1;
+    int bloom_mask = 2 * distance - 1;
+
+    // Step s hashes tuple s, reserves tuple s - half and stores tuple s - distance.
+    for (size_t s = begin; s < end + distance; s++) {
+        if (s < end) {
+            uint32_t hash;
+            int p = scatter_partition(range, stats != NULL, tuples[s].key, partition_count, &hash);
+            partitions[s & mask] = p;
+            partition_hashes[s & mask] = hash;
+            __builtin_prefetch(&sizes[p], 1);
+            __builtin_prefetch(&buffers[p], 0);
+            if (filters)
+                bloom_prefetch(bloom, filters, &tuples[s], p, blocks, hashes, s, bloom_mask);
+        }
+        size_t r = s - half;
+        if (s >= begin + half && r < end) {
+            int p = partitions[r & mask];
+            size_t idx = sizes[p];
+            tuple_t *slot = NULL;
+            if (idx >= capacity) {
+                fprintf(stderr, "Thread %d: Partition %d overflow (idx=%zu, cap=%zu)\n", thread_id, p, idx, capacity);
+            } else {
+                slot = &buffers[p][idx];
+                sizes[p] = idx + 1;
+                __builtin_prefetch(slot, 1);
+                if (stats)
+                    stats_fragment_add(stats_view, p, partition_hashes[r & mask], tuples[r].key);
+            }
+            slots[r & mask] = slot;
+        }
+        size_t w = s - distance;
+        if (s >= begin + distance && slots[w & mask]) {
+            *slots[w & mask] = tuples[w];
+            if (filters)
+                bloom_insert_hash(blocks[w & bloom_mask], hashes[w & bloom_mask]);
+        }
+    }
+}
+
+void scatter_concurrent_prefetch(const tuple_t *tuples, size_t begin, size_t end, int partition_count,
+                                 tuple_t **buffers, size_t *indexes, pthread_mutex_t *mutexes, size_t capacity,
+                                 int distance, int thread_id, const partition_opts_t *opts) {
+    int partitions[MAX_PREFETCH_DISTANCE];
+    uint32_t partition_hashes[MAX_PREFETCH_DISTANCE];
+    tuple_t *slots[MAX_PREFETCH_DISTANCE];
+    bloom_block_t *blocks[2 * MAX_PREFETCH_DISTANCE];
+    uint64_t hashes[2 * MAX_PREFETCH_DISTANCE];
+    bloom_set_t *bloom = opts ? opts->bloom : NULL;
+    partition_stats_t *stats = opts ? opts->stats : NULL;
+    const range_splitters_t *range = opts ? opts->range : NULL;
+    stats_fragment_t stats_view = stats ? partition_stats_fragment(stats, thread_id - 1) : (stats_fragment_t){0};
+    bloom_block_t *filters = bloom ? bloom_filter(bloom, thread_id - 1, 0) : NULL;
+    distance = clamp_distance(distance);
+    int half = distance / 2;
+    int mask = distance - 1;
+    int bloom_mask = 2 * distance - 1;
+
+    for (size_t s = begin; s < end + distance; s++) {
+        if (s < end) {
+            uint32_t hash;
+            int p = scatter_partition(range, stats != NULL, tuples[s].key, partition_count, &hash);
+            partitions[s & mask] = p;
+            partition_hashes[s & mask] = hash;
+            __builtin_prefetch(&mutexes[p], 1);
+            __builtin_prefetch(&indexes[p], 1);
+            __builtin_prefetch(&buffers[p], 0);
+            if (filters)
+                bloom_prefetch(bloom, filters, &tuples[s], p, blocks, hashes, s, bloom_mask);
+        }
+        size_t r = s - half;
+        if (s >= begin + half && r < end) {
+            int p = partitions[r & mask];
+            TRACE_LOCK(&mutexes[p]);
+            size_t idx = indexes[p];
+            if (idx < capacity)
+                indexes[p] = idx + 1;
+            pthread_mutex_unlock(&mutexes[p]);
+            tuple_t *slot = NULL;
+            if (idx >= capacity) {
+                fprintf(stderr, "Thread %d: Partition %d overflow (idx=%zu, cap=%zu)\n", thread_id, p, idx, capacity);
+            } else {
+                slot = &buffers[p][idx];
+                __builtin_prefetch(slot, 1);
+                if (stats)
+                    stats_fragment_add(stats_view, p, partition_hashes[r & mask], tuples[r].key);
+            }
+            slots[r & mask] = slot;
+        }
+        size_t w = s - distance;
+        if (s >= begin + distance && slots[w & mask]) {
+            *slots[w & mask] = tuples[w];
+            if (filters)
+                bloom_insert_hash(blocks[w & bloom_mask], hashes[w & bloom_mask]);
+        }
+    }
+}
+
+static void scatter_independent_plain(const tuple_t *tuples, size_t count, int partition_count, tuple_t **buffers,
+                                      size_t *sizes, size_t capacity) {
+    for (size_t i = 0; i < count; i++) {
+        int p = hash_to_partition(tuples[i].key, partition_count);
+        if (sizes[p] < capacity)
+            buffers[p][sizes[p]++] = tuples[i];
+    }
+}
+
+int tune_prefetch_distance(const tuple_t *tuples, size_t tuple_count, int partition_count) {
+    size_t sample = tuple_count < TUNE_SAMPLE ? tuple_count : TUNE_SAMPLE;
+    size_t capacity = (sample / partition_count) * PARTITION_MULTIPLIER + 16;
+    tuple_t *block = malloc((size_t)partition_count * capacity * sizeof(tuple_t));
+    tuple_t **buffers = malloc(partition_count * sizeof(tuple_t *));
+    size_t *sizes = malloc(partition_count * sizeof(size_t));
+    int best = tune_distances[0];
+    if (!block || !buffers || !sizes) {
+        free(block);
+        free(buffers);
+        free(sizes);
+        return best;
+    }
+    for (int p = 0; p < partition_count; p++)
+        buffers[p] = block + (size_t)p * capacity;
+
+    // The first round only warms up the buffers; the fastest later round wins.
+    double best_ms = 0.0;
+    for (int round = 0; round < 2; round++) {
+        for (size_t d = 0; d < sizeof(tune_distances) / sizeof(tune_distances[0]); d++) {
+            struct timespec start, end;
+            for (int p = 0; p < partition_count; p++)
+                sizes[p] = 0;
+            clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+            if (tune_distances[d] == 0)
+                scatter_independent_plain(tuples, sample, partition_count, buffers, sizes, capacity);
+            else
+                scatter_independent_prefetch(tuples, 0, sample, partition_count, buffers, sizes, capacity,
+                                             tune_distances[d], 0, NULL);
+            clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+            double ms = elapsed_ms(&start, &end);
+            if (round > 0 && (best_ms == 0.0 || ms < best_ms)) {
+                best_ms = ms;
+                best = tune_distances[d];
+            }
+        }
+    }
+
+    free(block);
+    free(buffers);
+    free(sizes);
+    return best;
+}
+
+int resolve_prefetch_distance(const partition_opts_t *opts, const tuple_t *tuples, size_t tuple_count,
+                              int partition_count) {
+    if (!opts)
+        return 0;
+    int distance = opts->prefetch_distance;
+    if (distance < 0)
+        distance = tune_prefetch_distance(tuples, tuple_count, partition_count);
+    if (distance == 0 && opts->bloom)
+        distance = BLOOM_PREFETCH_DISTANCE;
+    return distance > 0 ? clamp_distance(distance) : 0;
+}
+
+const fanout_kernels_t *scatter_fanout_kernels(const partition_opts_t *opts, int prefetch_distance,
+                                               int partition_count) {
+    if (!opts || !opts->specialized || prefetch_distance > 0 || opts->stats || opts->range || opts->predicate)
+        return NULL;
+    return fanout_kernels(__builtin_ctz((unsigned)partition_count));
+}
+
+int scatter_opts_prepare(const partition_opts_t *opts, int partition_count, int thread_count) {
+    if (!opts)
+        return 0;
+    bloom_set_t *bloom = opts->bloom;
+    partition_stats_t *stats = opts->stats;
+    if ((bloom && (bloom->partition_count != partition_count || bloom->fragment_count != thread_count)) ||
+        (stats && (stats->partition_count != partition_count || stats->fragment_count != thread_count)) ||
+        (opts->range && opts->range->partition_count != partition_count)) {
+        fprintf(stderr, "Bloom filters, statistics or range splitters do not match the partitioning run.\n");
+        return -1;
+    }
+    if (bloom)
+        bloom_set_clear(bloom);
+    if (stats)
+        partition_stats_clear(stats);
+    return 0;
+}
+
+void scatter_opts_finish(const partition_opts_t *opts, int fragment) {
+    if (!opts)
+        return;
+    if (opts->bloom)
+        bloom_set_merge(opts->bloom, fragment);
+    if (opts->stats)
+        partition_stats_merge(opts->stats, fragment);
+}
@@ -0,0 +1,67 @@
+#ifndef SCATTER_H
+#define SCATTER_H
+
+#include <pthread.h>
+#include "fanout.h"
+#include "project.h"
+#include "range.h"
+#include "utils.h"
+
+#define MAX_PREFETCH_DISTANCE 256
+#define BLOOM_PREFETCH_DISTANCE 16  // Used when Bloom filters are built but no distance was asked for.
+
+// Software-pipelined scatter kernels. Tuple i is hashed and its counter prefetched at step i,
+// its slot is reserved and the destination line prefetched at step i + distance / 2, and the
+// tuple is stored at step i + distance, once those lines have had time to arrive.
+// opts may be NULL. With opts->bloom set, the kernels also insert every stored tuple into this
+// thread's fragment of the filters, whose block is prefetched along with the partition counter;
+// with opts->stats set, they fold it into this thread's partition statistics.
+
+// Independent path: private buffers and sizes, tuples beyond capacity are dropped and reported.
+void scatter_independent_prefetch(const tuple_t *tuples, size_t begin, size_t end, int partition_count,
+                                  tuple_t **buffers, size_t *sizes, size_t capacity, int distance, int thread_id,
+                                  const partition_opts_t *opts);
+
+// Concurrent path: shared buffers whose indexes are reserved under the partition mutexes.
+void scatter_concurrent_prefetch(const tuple_t *tuples, size_t begin, size_t end, int partition_count,
+                                 tuple_t **buffers, size_t *indexes, pthread_mutex_t *mutexes, size_t capacity,
+                                 int distance, int thread_id, const partition_opts_t *opts);
+
+// Picks the distance that scatters a sample of tuples fastest at this fan-out; 0 when the
+// plain loop beats every pipelined one.
+int tune_prefetch_distance(const tuple_t *tuples, size_t tuple_count, int partition_count);
+
+// Resolves opts to a concrete distance for this run (0 when prefetching is off). Distances are
+// rounded up to a power of two. Runs building Bloom filters always get a distance, since their
+// random filter accesses need the pipeline to hide the cache misses.
+int resolve_prefetch_distance(const partition_opts_t *opts, const tuple_t *tuples, size_t tuple_count,
+                              int partition_count);
+
+// Partition of key: its range when range is set, otherwise the low bits of its Murmur hash. hash
+// receives the Murmur hash, which range partitioning only computes when need_hash is set.
+static inline int scatter_partition(const range_splitters_t *range, int need_hash, const unsigned char *key,
+                                    int partition_count, uint32_t *hash) {
+    if (range) {
+        *hash = need_hash ? hash_key(key) : 0;
+        return range_partition(range, key);
+    }
+    *hash = hash_key(key);
+    return (int)(*hash % partition_count);
+}
+
+// Kernels compiled for this fan-out when opts asks for them and the run needs nothing beyond
+// the plain scatter (no prefetching, statistics, range splitters or predicate, whose small
+// windows would pay for the kernels' counter copies); NULL otherwise.
+const fanout_kernels_t *scatter_fanout_kernels(const partition_opts_t *opts, int prefetch_distance,
+                                               int partition_count);
+
+// Checks that opts' Bloom filters and statistics have one fragment per thread and that they and
+// the range splitters match this fan-out, then clears the filters and statistics. Returns 0 on
+// success (or NULL opts), -1 on a mismatch.
+int scatter_opts_prepare(const partition_opts_t *opts, int partition_count, int thread_count);
+
+// Called by every scatter thread (fragment = thread index) after its last tuple: merges the
+// per-thread Bloom filters and statistics, waiting for the other threads first.
+void scatter_opts_finish(const partition_opts_t *opts, int fragment);
+
+#endif
@@ -34,6 +34,40 @@ def load_throughput_data(filename):
             })
     return pd.DataFrame(rows)
 
+ROOFLINE_VARIANTS = ("no_affinity", "cpu_aff", "numa")
+
+def load_roofline(results_dir, label):
+    """
+    Returns the scatter ceiling measured by `make run_roofline` for the affinity variant in
+    label (e.g. independent_cpu_aff -> roofline_cpu_aff_scatter), or None if there is none.
+    The ceiling is averaged per (Threads, HashBits) into a Ceiling column.
+    """
+    for variant in ROOFLINE_VARIANTS:
+        if label.endswith(variant):
+            path = os.path.join(results_dir, f"roofline_{variant}_scatter_results.txt")
+            if not os.path.exists(path):
+                return None
+            df = load_throughput_data(path)
+            if df.empty:
+                return None
+            df = df.groupby(["Threads", "HashBits"])["Throughput"].mean().reset_index()
+            return df.rename(columns={"Throughput": "Ceiling"})
+    return None
+
+def report_percent_of_roofline(df, roofline, label, output_dir):
+    """
+    Writes the mean throughput of each (Threads, HashBits) point as a percentage of the
+    scatter ceiling to <label>_roofline_percent.csv and prints the median per thread count.
+    """
+    mean_df = df.groupby(["Threads", "HashBits"])["Throughput"].mean().reset_index()
+    merged = mean_df.merge(roofline, on=["Threads", "HashBits"])
+    if merged.empty:
+        return
+    merged["PercentOfCeiling"] = 100.0 * merged["Throughput"] / merged["Ceiling"]
+    merged.to_csv(os.path.join(output_dir, f"{label}_roofline_percent.csv"), index=False, float_format="%.2f")
+    for thread, sub_df in merged.groupby("Threads"):
+        print(f"{label}: {thread} threads at {sub_df['PercentOfCeiling'].median():.1f}% of the scatter ceiling (median)")
+
 def main():
     results_dir = "results"
     output_dir = os.path.join("images", "throughput")
@@ -42,13 +76,18 @@ def main():
     # Use updated glob patterns so that files are matched correctly.
     independent_files = sorted(glob.glob(os.path.join(results_dir, "independent*results.txt")))
     concurrent_files = sorted(glob.glob(os.path.join(results_dir, "concurrent*results.txt")))
+    delegation_files = sorted(glob.glob(os.path.join(results_dir, "delegation*results.txt")))
     
     print(f"Found {len(independent_files)} independent files.")
     print(f"Found {len(concurrent_files)} concurrent files.")
+    print(f"Found {len(delegation_files)} delegation files.")
+
+    # One column per strategy that has results.
+    columns = [files for files in (independent_files, concurrent_files, delegation_files) if files]
 
     # Load the data from all files so we can compute global axis limits.
     all_dfs = []
-    for file in independent_files + concurrent_files:
+    for file in independent_files + concurrent_files + delegation_files:
         df = load_throughput_data(file)
         if not df.empty:
             all_dfs.append(df)
@@ -64,18 +103,26 @@ def main():
     global_y_min = combined_df["Throughput"].min()
     global_y_max = combined_df["Throughput"].max()
 
+    # Scatter ceilings per strategy file, when the roofline has been measured.
+    rooflines = {}
+    for file in independent_files + concurrent_files + delegation_files:
+        label = os.path.basename(file).replace("_results.txt", "")
+        roofline = load_roofline(results_dir, label)
+        if roofline is not None:
+            rooflines[file] = roofline
+            global_y_max = max(global_y_max, roofline["Ceiling"].max())
+
     # Optionally add a little margin on the axes.
     x_margin = (global_x_max - global_x_min) * 0.05 if global_x_max != global_x_min else 1
     y_margin = (global_y_max - global_y_min) * 0.05 if global_y_max != global_y_min else 1
     xlims = (global_x_min - x_margin, global_x_max + x_margin)
     ylims = (global_y_min - y_margin, global_y_max + y_margin)
 
-    # Set up a 3x2 grid: left column for independent, right column for concurrent.
-    fig, axes = plt.subplots(nrows=3, ncols=2, figsize=(14, 12))
+    # Set up a 3xN grid with one column per strategy (independent, concurrent, delegation).
+    fig, axes = plt.subplots(nrows=3, ncols=len(columns), figsize=(7 * len(columns), 12), squeeze=False)
     
     # Process files per column:
-    file_groups = [(independent_files, 0), (concurrent_files, 1)]
-    for file_list, col in file_groups:
+    for col, file_list in enumerate(columns):
         for row, filepath in enumerate(file_list):
             if row >= 3:
                 continue  # Limit to 3 plots per column
@@ -89,7 +136,16 @@ def main():
                 sub_df = df[df["Threads"] == thread]
                 # Group by HashBits to compute average throughput.
                 mean_df = sub_df.groupby("HashBits")["Throughput"].mean().reset_index()
-                ax.plot(mean_df["HashBits"], mean_df["Throughput"], marker="o", label=f"Threads = {thread}")
+                line, = ax.plot(mean_df["HashBits"], mean_df["Throughput"], marker="o", label=f"Threads = {thread}")
+                # Overlay the scatter ceiling for the same thread count as a dashed line.
+                roofline = rooflines.get(filepath)
+                if roofline is not None:
+                    ceiling = roofline[roofline["Threads"] == thread]
+                    if not ceiling.empty:
+                        ax.plot(ceiling["HashBits"], ceiling["Ceiling"], linestyle="--", color=line.get_color(),
+                                label=f"Ceiling, {thread} threads")
+            if filepath in rooflines:
+                report_percent_of_roofline(df, rooflines[filepath], label, output_dir)
             ax.set_title(label)
             ax.set_xlabel("HashBits")
             ax.set_ylabel("Throughput (MT/s)")
@@ -101,8 +157,8 @@ def main():
 
     # Remove any unused axes if there are fewer than 3 plots per column.
     for row in range(3):
-        for col in range(2):
-            if (col == 0 and row >= len(independent_files)) or (col == 1 and row >= len(concurrent_files)):
+        for col, file_list in enumerate(columns):
+            if row >= len(file_list):
                 fig.delaxes(axes[row][col])
                 
     fig.tight_layout()
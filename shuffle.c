@@ -0,0 +1,419 @@
+#define _GNU_SOURCE
+#include "project.h"
+#include "utils.h"
+#include "chunk_store.h"
+#include "shuffle.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define RING_SLOTS 4096         // Tuples per shared-memory ring (power of two).
+#define BATCH_SIZE 64           // Tuples staged per destination before they are sent.
+#define DRAIN_INTERVAL 1024     // Input tuples between opportunistic drains.
+#define RECV_BYTES (64 * 1024)  // Socket receive buffer per read.
+
+// Same single-producer/single-consumer ring as in delegation.c, but living in a POSIX shm
+// segment shared by all processes. Lock-free atomics on shared mappings are process-shared.
+// Only tuples travel; the owner hashes them again, as it would when reading from a network.
+typedef struct {
+    unsigned long tail __attribute__((aligned(64)));
+    unsigned long head __attribute__((aligned(64)));
+    int done __attribute__((aligned(64)));
+    tuple_t slots[RING_SLOTS] __attribute__((aligned(64)));
+} shm_ring_t;
+
+typedef struct {
+    int self;
+    int process_count;
+    int partition_count;
+    shuffle_transport_t transport;
+    shm_ring_t *rings;          // SHM: process_count x process_count, rings[sender * process_count + owner].
+    int *send_fds;              // SOCKET: one non-blocking socket per peer (-1 for self).
+    int *recv_fds;
+    unsigned char *recv_buffer;
+    int *carry_bytes;           // SOCKET: partial tuple bytes left over from the last read, per peer.
+    unsigned char *carry;
+    int open_peers;             // Peers that may still send to us.
+    int *peer_open;
+    tuple_t *staged;            // process_count x BATCH_SIZE tuples staged per owner.
+    int *staged_counts;
+    unsigned long *cached_heads;
+    chunk_store_t store;
+    shuffle_stats_t *stats;
+} process_args_t;
+
+static const char *transport_names[] = {"shm", "socket"};
+
+int parse_transport(const char *name, shuffle_transport_t *transport) {
+    for (int i = 0; i < 2; i++) {
+        if (strcmp(name, transport_names[i]) == 0) {
+            *transport = (shuffle_transport_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *transport_name(shuffle_transport_t transport) {
+    return transport_names[transport];
+}
+
+static inline int owner_of(int partition, int partition_count, int process_count) {
+    return (int)(((long)partition * process_count) / partition_count);
+}
+
+static inline void store_owned(process_args_t *args, const tuple_t *tuple) {
+    int partition = hash_to_partition(tuple->key, args->partition_count);
+    if (owner_of(partition, args->partition_count, args->process_count) != args->self)
+        args->stats->errors++;
+    chunk_list_append(&args->store.lists[partition], &args->store.pools[0], tuple);
+}
+
+static int drain_shm(process_args_t *args) {
+    int drained = 0;
+    for (int sender = 0; sender < args->process_count; sender++) {
+        if (!args->peer_open[sender])
+            continue;
+        shm_ring_t *ring = &args->rings[sender * args->process_count + args->self];
+        int done = __atomic_load_n(&ring->done, __ATOMIC_ACQUIRE);
+        unsigned long tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        unsigned long head = ring->head;
+        for (; head < tail; head++)
+            store_owned(args, &ring->slots[head & (RING_SLOTS - 1)]);
+        drained += (int)(tail - ring->head);
+        __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+        // done was read before tail, so everything the sender pushed has been drained.
+        if (done) {
+            args->peer_open[sender] = 0;
+            args->open_peers--;
+        }
+    }
+    args->stats->tuples_received += drained;
+    return drained;
+}
+
+static int drain_sockets(process_args_t *args) {
+    int drained = 0;
+    for (int sender = 0; sender < args->process_count; sender++) {
+        if (!args->peer_open[sender])
+            continue;
+        unsigned char *carry = args->carry + sender * sizeof(tuple_t);
+        int carried = args->carry_bytes[sender];
+        memcpy(args->recv_buffer, carry, carried);
+        ssize_t n = read(args->recv_fds[sender], args->recv_buffer + carried, RECV_BYTES);
+        if (n == 0) {
+            args->peer_open[sender] = 0;
+            args->open_peers--;
+            continue;
+        }
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("read");
+                args->stats->errors++;
+                args->peer_open[sender] = 0;
+                args->open_peers--;
+            }
+            continue;
+        }
+        size_t bytes = carried + (size_t)n;
+        size_t whole = bytes / sizeof(tuple_t);
+        for (size_t i = 0; i < whole; i++) {
+            tuple_t tuple;
+            memcpy(&tuple, args->recv_buffer + i * sizeof(tuple_t), sizeof(tuple_t));
+            store_owned(args, &tuple);
+        }
+        args->carry_bytes[sender] = (int)(bytes - whole * sizeof(tuple_t));
+        memcpy(carry, args->recv_buffer + whole * sizeof(tuple_t), args->carry_bytes[sender]);
+        drained += (int)whole;
+    }
+    args->stats->tuples_received += drained;
+    return drained;
+}
+
+static int drain_incoming(process_args_t *args) {
+    return args->transport == SHUFFLE_SHM ? drain_shm(args) : drain_sockets(args);
+}
+
+// Both transports drain our own incoming data while the destination is full, so that two
+// processes waiting on each other still make progress.
+static void send_shm(process_args_t *args, int owner, const tuple_t *batch, int count) {
+    shm_ring_t *ring = &args->rings[args->self * args->process_count + owner];
+    unsigned long tail = ring->tail;
+    while (tail - args->cached_heads[owner] + count > RING_SLOTS) {
+        args->cached_heads[owner] = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (tail - args->cached_heads[owner] + count <= RING_SLOTS)
+            break;
+        if (drain_incoming(args) == 0)
+            sched_yield();
+    }
+    unsigned long slot = tail & (RING_SLOTS - 1);
+    int first = RING_SLOTS - (int)slot < count ? RING_SLOTS - (int)slot : count;
+    memcpy(&ring->slots[slot], batch, first * sizeof(tuple_t));
+    memcpy(&ring->slots[0], batch + first, (count - first) * sizeof(tuple_t));
+    __atomic_store_n(&ring->tail, tail + count, __ATOMIC_RELEASE);
+}
+
+static void send_socket(process_args_t *args, int owner, const tuple_t *batch, int count) {
+    const unsigned char *bytes = (const unsigned char *)batch;
+    size_t remaining = count * sizeof(tuple_t);
+    while (remaining > 0) {
+        ssize_t n = send(args->send_fds[owner], bytes, remaining, MSG_NOSIGNAL);
+        if (n > 0) {
+            bytes += n;
+            remaining -= n;
+        } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            perror("send");
+            args->stats->errors++;
+            return;
+        } else if (drain_incoming(args) == 0) {
+            sched_yield();
+        }
+    }
+}
+
+static void flush_staged(process_args_t *args, int owner) {
+    int count = args->staged_counts[owner];
+    if (count == 0)
+        return;
+    const tuple_t *batch = args->staged + owner * BATCH_SIZE;
+    if (args->transport == SHUFFLE_SHM)
+        send_shm(args, owner, batch, count);
+    else
+        send_socket(args, owner, batch, count);
+    args->stats->tuples_sent += count;
+    args->staged_counts[owner] = 0;
+}
+
+static void shuffle_shard(process_args_t *args, const tuple_t *tuples, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        int partition = hash_to_partition(tuples[i].key, args->partition_count);
+        int owner = owner_of(partition, args->partition_count, args->process_count);
+        if (owner == args->self) {
+            chunk_list_append(&args->store.lists[partition], &args->store.pools[0], &tuples[i]);
+            args->stats->tuples_kept++;
+        } else {
+            int n = args->staged_counts[owner]++;
+            args->staged[owner * BATCH_SIZE + n] = tuples[i];
+            if (n + 1 == BATCH_SIZE)
+                flush_staged(args, owner);
+        }
+        if ((i - begin) % DRAIN_INTERVAL == DRAIN_INTERVAL - 1)
+            drain_incoming(args);
+    }
+
+    // Send the partial batches and tell every owner we are done.
+    for (int owner = 0; owner < args->process_count; owner++) {
+        if (owner == args->self)
+            continue;
+        flush_staged(args, owner);
+        if (args->transport == SHUFFLE_SHM)
+            __atomic_store_n(&args->rings[args->self * args->process_count + owner].done, 1, __ATOMIC_RELEASE);
+        else
+            shutdown(args->send_fds[owner], SHUT_WR);
+    }
+    while (args->open_peers > 0) {
+        if (drain_incoming(args) == 0)
+            sched_yield();
+    }
+}
+
+// Body of worker process self. Returns the process exit status.
+static int run_process(process_args_t *args, const tuple_t *tuples, int tuple_count, pthread_barrier_t *barrier) {
+    int p = args->process_count;
+    args->staged = malloc(p * BATCH_SIZE * sizeof(tuple_t));
+    args->staged_counts = calloc(p, sizeof(int));
+    args->cached_heads = calloc(p, sizeof(unsigned long));
+    args->peer_open = calloc(p, sizeof(int));
+    args->carry_bytes = calloc(p, sizeof(int));
+    args->carry = malloc(p * sizeof(tuple_t));
+    args->recv_buffer = malloc(RECV_BYTES + sizeof(tuple_t));
+    if (!args->staged || !args->staged_counts || !args->cached_heads || !args->peer_open || !args->carry_bytes ||
+        !args->carry || !args->recv_buffer || chunk_store_init(&args->store, args->partition_count, 1, 1) != 0) {
+        fprintf(stderr, "Process %d: allocation failed.\n", args->self);
+        args->stats->errors++;
+        pthread_barrier_wait(barrier);
+        return 1;
+    }
+    for (int i = 0; i < p; i++)
+        args->peer_open[i] = i != args->self;
+    args->open_peers = p - 1;
+
+    int base = tuple_count / p;
+    int begin = args->self * base;
+    int end = args->self == p - 1 ? tuple_count : begin + base;
+
+    pthread_barrier_wait(barrier);
+    clock_gettime(CLOCK_MONOTONIC, &args->stats->start);
+    shuffle_shard(args, tuples, begin, end);
+    clock_gettime(CLOCK_MONOTONIC, &args->stats->end);
+
+    shuffle_stats_t *stats = args->stats;
+    stats->elapsed_ms = elapsed_ms(&stats->start, &stats->end);
+    double seconds = stats->elapsed_ms / 1000.0;
+    stats->send_mbps = stats->tuples_sent * sizeof(tuple_t) / seconds / 1e6;
+    stats->recv_mbps = stats->tuples_received * sizeof(tuple_t) / seconds / 1e6;
+
+    long stored = 0;
+    for (int partition = 0; partition < args->partition_count; partition++)
+        stored += chunk_store_partition_size(&args->store, partition);
+    if (stored != stats->tuples_kept + stats->tuples_received)
+        stats->errors++;
+    chunk_store_free(&args->store);
+    return stats->errors ? 1 : 0;
+}
+
+// Creates a socketpair per ordered pair of processes: fds[2 * (sender * p + owner)] is the
+// sender's end, the next one the owner's.
+static int open_sockets(int process_count, int *fds) {
+    for (int i = 0; i < process_count * process_count; i++) {
+        fds[2 * i] = fds[2 * i + 1] = -1;
+        if (i / process_count == i % process_count)
+            continue;
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, &fds[2 * i]) != 0) {
+            perror("socketpair");
+            return -1;
+        }
+        fcntl(fds[2 * i], F_SETFL, O_NONBLOCK);
+        fcntl(fds[2 * i + 1], F_SETFL, O_NONBLOCK);
+    }
+    return 0;
+}
+
+static void close_sockets(int process_count, int *fds) {
+    for (int i = 0; i < 2 * process_count * process_count; i++) {
+        if (fds[i] >= 0)
+            close(fds[i]);
+    }
+}
+
+static shm_ring_t *map_rings(int process_count, size_t bytes) {
+    char name[64];
+    snprintf(name, sizeof(name), "/partition_shuffle_%d", (int)getpid());
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        perror("shm_open");
+        return NULL;
+    }
+    // The mapping outlives the name, so unlink right away and nothing is left behind on exit.
+    shm_unlink(name);
+    void *rings = MAP_FAILED;
+    if (ftruncate(fd, bytes) == 0)
+        rings = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    else
+        perror("ftruncate");
+    close(fd);
+    return rings == MAP_FAILED ? NULL : rings;
+}
+
+int run_shuffle_timed(tuple_t *tuples, int tuple_count, int process_count, int hash_bits,
+                      shuffle_transport_t transport, shuffle_stats_t *stats, double *throughput) {
+    if (!tuples || !stats || !throughput || process_count <= 0)
+        return -1;
+
+    // Counters and the start barrier live in an anonymous shared mapping inherited by the children.
+    size_t shared_bytes = sizeof(pthread_barrier_t) + process_count * sizeof(shuffle_stats_t);
+    unsigned char *shared = mmap(NULL, shared_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+    pthread_barrier_t *barrier = (pthread_barrier_t *)shared;
+    shuffle_stats_t *shared_stats = (shuffle_stats_t *)(shared + sizeof(pthread_barrier_t));
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(barrier, &attr, process_count);
+    pthread_barrierattr_destroy(&attr);
+
+    size_t ring_bytes = (size_t)process_count * process_count * sizeof(shm_ring_t);
+    shm_ring_t *rings = NULL;
+    int *fds = NULL;
+    int status = 0;
+    if (transport == SHUFFLE_SHM) {
+        rings = map_rings(process_count, ring_bytes);
+        status = rings ? 0 : -1;
+    } else {
+        fds = malloc(2 * process_count * process_count * sizeof(int));
+        status = fds && open_sockets(process_count, fds) == 0 ? 0 : -1;
+    }
+
+    pid_t pids[process_count];
+    int started = 0;
+    for (int i = 0; i < process_count && status == 0; i++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            status = -1;
+            break;
+        }
+        if (pid == 0) {
+            process_args_t args = {.self = i, .process_count = process_count, .partition_count = 1 << hash_bits,
+                                   .transport = transport, .rings = rings, .stats = &shared_stats[i]};
+            int send_fds[process_count], recv_fds[process_count];
+            if (fds) {
+                // Keep only our own ends so that closing them is all the peers ever see.
+                for (int j = 0; j < process_count; j++) {
+                    send_fds[j] = fds[2 * (i * process_count + j)];
+                    recv_fds[j] = fds[2 * (j * process_count + i) + 1];
+                    fds[2 * (i * process_count + j)] = fds[2 * (j * process_count + i) + 1] = -1;
+                }
+                close_sockets(process_count, fds);
+                args.send_fds = send_fds;
+                args.recv_fds = recv_fds;
+            }
+            _exit(run_process(&args, tuples, tuple_count, barrier));
+        }
+        pids[started++] = pid;
+    }
+    if (fds) {
+        close_sockets(process_count, fds);
+        free(fds);
+    }
+    // A child that never started or gave up would leave its peers waiting on it forever,
+    // so the first failure takes the remaining processes down.
+    if (status != 0) {
+        for (int i = 0; i < started; i++)
+            kill(pids[i], SIGKILL);
+    }
+    for (int remaining = started; remaining > 0; remaining--) {
+        int child_status;
+        pid_t pid = waitpid(-1, &child_status, 0);
+        if (pid < 0)
+            break;
+        if (!WIFEXITED(child_status) || WEXITSTATUS(child_status) != 0) {
+            if (status == 0) {
+                for (int i = 0; i < started; i++)
+                    kill(pids[i], SIGKILL);
+            }
+            status = -1;
+        }
+    }
+
+    if (status == 0) {
+        // End to end: from the first process starting to the last one finishing.
+        struct timespec first = shared_stats[0].start, last = shared_stats[0].end;
+        for (int i = 1; i < process_count; i++) {
+            if (elapsed_ms(&shared_stats[i].start, &first) > 0)
+                first = shared_stats[i].start;
+            if (elapsed_ms(&last, &shared_stats[i].end) > 0)
+                last = shared_stats[i].end;
+        }
+        *throughput = tuple_count / (elapsed_ms(&first, &last) * 1000.0);
+        memcpy(stats, shared_stats, process_count * sizeof(shuffle_stats_t));
+    }
+
+    if (rings)
+        munmap(rings, ring_bytes);
+    pthread_barrier_destroy(barrier);
+    munmap(shared, shared_bytes);
+    return status;
+}
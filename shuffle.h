@@ -0,0 +1,37 @@
+#ifndef SHUFFLE_H
+#define SHUFFLE_H
+
+#include <time.h>
+#include "project.h"
+
+typedef enum {
+    SHUFFLE_SHM,     // POSIX shared-memory SPSC rings between every pair of processes.
+    SHUFFLE_SOCKET,  // Unix-domain stream sockets, standing in for a network link.
+} shuffle_transport_t;
+
+// Per-process counters, written by each worker process into shared memory.
+typedef struct {
+    long tuples_kept;       // Tuples whose partition this process owns itself.
+    long tuples_sent;
+    long tuples_received;
+    double send_mbps;       // Bytes sent / received per second of this process's run, in MB/s.
+    double recv_mbps;
+    double elapsed_ms;
+    struct timespec start;
+    struct timespec end;
+    int errors;
+} shuffle_stats_t;
+
+// Parses "shm" / "socket". Returns 0 on success, -1 on unknown names.
+int parse_transport(const char *name, shuffle_transport_t *transport);
+const char *transport_name(shuffle_transport_t transport);
+
+// Shuffle across process_count forked processes: process i partitions the i-th shard of the
+// input and delivers partition p to its owner (a contiguous range of partitions per process)
+// over the chosen transport. Owners store what they keep and receive in chunked partitions.
+// stats must hold process_count entries. throughput is the end-to-end rate, in million
+// tuples/s, from the first process starting to the last one finishing.
+int run_shuffle_timed(tuple_t *tuples, int tuple_count, int process_count, int hash_bits,
+                      shuffle_transport_t transport, shuffle_stats_t *stats, double *throughput);
+
+#endif
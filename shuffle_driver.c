@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "shuffle.h"
+#include "project.h"
+#include "utils.h"
+#include "tuples.h"
+
+#define TUPLE_COUNT (1 << 24)  // ~16 million tuples
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <PROCESS_COUNT> <HASHBITS> [shm|socket]\n", argv[0]);
+        return -1;
+    }
+    int process_count = atoi(argv[1]);
+    int hash_bits = atoi(argv[2]);
+    shuffle_transport_t transport = SHUFFLE_SHM;
+    if (argc > 3 && parse_transport(argv[3], &transport) != 0) {
+        fprintf(stderr, "Unknown transport '%s'.\n", argv[3]);
+        return -1;
+    }
+    if (process_count <= 0) {
+        fprintf(stderr, "Process count must be positive.\n");
+        return -1;
+    }
+
+    // Generate tuples. The forked processes share them copy-on-write and read only their shard.
+    tuple_t *tuples = generate_tuples(TUPLE_COUNT);
+    shuffle_stats_t *stats = calloc(process_count, sizeof(shuffle_stats_t));
+    if (!tuples || !stats) {
+        fprintf(stderr, "Error generating tuples.\n");
+        free(tuples);
+        free(stats);
+        return -1;
+    }
+
+    // Run experiment.
+    double throughput = 0.0;
+    if (run_shuffle_timed(tuples, TUPLE_COUNT, process_count, hash_bits, transport, stats, &throughput) != 0) {
+        fprintf(stderr, "Error in %s shuffle with %d processes and %d hashbits\n", transport_name(transport),
+                process_count, hash_bits);
+    } else {
+        // One CSV row per process; Throughput is the end-to-end shuffle rate and repeats on each row.
+        printf("Processes,HashBits,Transport,Process,Kept,Sent,Received,SendMBps,RecvMBps,Throughput\n");
+        for (int i = 0; i < process_count; i++) {
+            printf("%d,%d,%s,%d,%ld,%ld,%ld,%.2f,%.2f,%.2f\n", process_count, hash_bits, transport_name(transport), i,
+                   stats[i].tuples_kept, stats[i].tuples_sent, stats[i].tuples_received, stats[i].send_mbps,
+                   stats[i].recv_mbps, throughput);
+        }
+    }
+
+    free(tuples);
+    free(stats);
+    return 0;
+}
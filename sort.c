@@ -0,0 +1,199 @@
+#define _GNU_SOURCE
+#include "project.h"
+#include "utils.h"
+#include "tasks.h"
+#include "sort.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+typedef struct {
+    tuple_t *tuples;
+    int tuple_count;
+    int thread_count;
+    int partition_bits;
+    int partition_count;
+    int *histograms;         // thread_count x partition_count counts, then scatter cursors.
+    int *partition_offsets;  // partition_count + 1 starting positions in out.
+    tuple_t *out;
+    tuple_t *scratch;
+} sort_ctx_t;
+
+static inline int range_partition(const tuple_t *tuple, int partition_bits) {
+    return (int)(load_u64(tuple->key) >> (64 - partition_bits));
+}
+
+static inline void segment_bounds(const sort_ctx_t *ctx, int segment, int *start, int *end) {
+    int base_segment_size = ctx->tuple_count / ctx->thread_count;
+    *start = base_segment_size * segment;
+    *end = (segment == ctx->thread_count - 1) ? ctx->tuple_count : (*start + base_segment_size);
+}
+
+static void histogram_segment(int segment, int worker_id, void *void_ctx) {
+    (void)worker_id;
+    sort_ctx_t *ctx = (sort_ctx_t *)void_ctx;
+    int *counts = ctx->histograms + segment * ctx->partition_count;
+    int start, end;
+    segment_bounds(ctx, segment, &start, &end);
+    TRACE_BEGIN("histogram");
+    for (int i = start; i < end; i++)
+        counts[range_partition(&ctx->tuples[i], ctx->partition_bits)]++;
+    TRACE_END("histogram");
+}
+
+static void scatter_segment(int segment, int worker_id, void *void_ctx) {
+    (void)worker_id;
+    sort_ctx_t *ctx = (sort_ctx_t *)void_ctx;
+    int *cursors = ctx->histograms + segment * ctx->partition_count;
+    int start, end;
+    segment_bounds(ctx, segment, &start, &end);
+    TRACE_BEGIN("scatter");
+    for (int i = start; i < end; i++)
+        ctx->out[cursors[range_partition(&ctx->tuples[i], ctx->partition_bits)]++] = ctx->tuples[i];
+    TRACE_END("scatter");
+}
+
+// LSD radix sort of data[0..count) on key bits [low_bit, high_bit), using tmp as the second buffer.
+// The sorted result is always left in data. Passes whose digit is the same for every tuple are skipped.
+static void radix_sort_range(tuple_t *data, tuple_t *tmp, int count, int low_bit, int high_bit) {
+    int counts[RADIX_BUCKETS];
+    tuple_t *src = data;
+    tuple_t *dst = tmp;
+
+    for (int shift = low_bit; shift < high_bit; shift += RADIX_BITS) {
+        memset(counts, 0, sizeof(counts));
+        for (int i = 0; i < count; i++)
+            counts[(load_u64(src[i].key) >> shift) & (RADIX_BUCKETS - 1)]++;
+
+        int skip = 0;
+        int offset = 0;
+        for (int b = 0; b < RADIX_BUCKETS; b++) {
+            if (counts[b] == count)
+                skip = 1;
+            int c = counts[b];
+            counts[b] = offset;
+            offset += c;
+        }
+        if (skip)
+            continue;
+
+        for (int i = 0; i < count; i++)
+            dst[counts[(load_u64(src[i].key) >> shift) & (RADIX_BUCKETS - 1)]++] = src[i];
+        tuple_t *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != data)
+        memcpy(data, src, count * sizeof(tuple_t));
+}
+
+static void sort_partition(int partition, int worker_id, void *void_ctx) {
+    (void)worker_id;
+    sort_ctx_t *ctx = (sort_ctx_t *)void_ctx;
+    int start = ctx->partition_offsets[partition];
+    int count = ctx->partition_offsets[partition + 1] - start;
+    // The top partition_bits are equal within a partition, so only the remaining bits are sorted.
+    radix_sort_range(ctx->out + start, ctx->scratch + start, count, 0, 64 - ctx->partition_bits);
+}
+
+int run_partition_sort_timed(tuple_t *tuples, int tuple_count, int thread_count, int partition_bits,
+                             tuple_t *out, tuple_t *scratch, sort_result_t *result) {
+    if (!tuples || !out || !scratch || !result || partition_bits < 1 || partition_bits > 30)
+        return -1;
+
+    sort_ctx_t ctx = {
+        .tuples = tuples,
+        .tuple_count = tuple_count,
+        .thread_count = thread_count,
+        .partition_bits = partition_bits,
+        .partition_count = 1 << partition_bits,
+        .out = out,
+        .scratch = scratch,
+    };
+    ctx.histograms = calloc((size_t)thread_count * ctx.partition_count, sizeof(int));
+    ctx.partition_offsets = malloc((ctx.partition_count + 1) * sizeof(int));
+    if (!ctx.histograms || !ctx.partition_offsets) {
+        fprintf(stderr, "Error allocating sort histograms.\n");
+        free(ctx.histograms);
+        free(ctx.partition_offsets);
+        return -1;
+    }
+
+    struct timespec start, partitioned, end;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    int ret = run_tasks(thread_count, thread_count, histogram_segment, &ctx);
+
+    // Turn the counts into scatter cursors: partitions in key order, threads in input order within each.
+    int offset = 0;
+    for (int p = 0; p < ctx.partition_count; p++) {
+        ctx.partition_offsets[p] = offset;
+        for (int t = 0; t < thread_count; t++) {
+            int *count = &ctx.histograms[t * ctx.partition_count + p];
+            int c = *count;
+            *count = offset;
+            offset += c;
+        }
+    }
+    ctx.partition_offsets[ctx.partition_count] = offset;
+
+    if (ret == 0)
+        ret = run_tasks(thread_count, thread_count, scatter_segment, &ctx);
+    clock_gettime(CLOCK_MONOTONIC_RAW, &partitioned);
+    if (ret == 0)
+        ret = run_tasks(thread_count, ctx.partition_count, sort_partition, &ctx);
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+
+    result->partition_ms = elapsed_ms(&start, &partitioned);
+    result->sort_ms = elapsed_ms(&partitioned, &end);
+    result->throughput = ((double)tuple_count / (elapsed_ms(&start, &end) / 1000.0)) / 1e6;
+
+    free(ctx.histograms);
+    free(ctx.partition_offsets);
+    return ret;
+}
+
+int run_radix_sort_timed(tuple_t *tuples, int tuple_count, tuple_t *out, tuple_t *scratch, double *throughput) {
+    if (!tuples || !out || !scratch)
+        return -1;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    memcpy(out, tuples, (size_t)tuple_count * sizeof(tuple_t));
+    radix_sort_range(out, scratch, tuple_count, 0, 64);
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+
+    *throughput = ((double)tuple_count / (elapsed_ms(&start, &end) / 1000.0)) / 1e6;
+    return 0;
+}
+
+static int compare_keys(const void *a, const void *b) {
+    uint64_t ka = load_u64(((const tuple_t *)a)->key);
+    uint64_t kb = load_u64(((const tuple_t *)b)->key);
+    return (ka > kb) - (ka < kb);
+}
+
+int run_qsort_timed(tuple_t *tuples, int tuple_count, tuple_t *out, double *throughput) {
+    if (!tuples || !out)
+        return -1;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    memcpy(out, tuples, (size_t)tuple_count * sizeof(tuple_t));
+    qsort(out, tuple_count, sizeof(tuple_t), compare_keys);
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+
+    *throughput = ((double)tuple_count / (elapsed_ms(&start, &end) / 1000.0)) / 1e6;
+    return 0;
+}
+
+int is_sorted_by_key(const tuple_t *tuples, int tuple_count) {
+    for (int i = 1; i < tuple_count; i++) {
+        if (load_u64(tuples[i - 1].key) > load_u64(tuples[i].key))
+            return 0;
+    }
+    return 1;
+}
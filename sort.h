@@ -0,0 +1,28 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include "project.h"
+
+// Keys are compared as native-endian 64-bit unsigned integers.
+typedef struct {
+    double partition_ms;   // Histogram, prefix sum and scatter on the high key bits.
+    double sort_ms;        // Per-partition radix sorts.
+    double throughput;     // Millions of tuples per second, end-to-end.
+} sort_result_t;
+
+// Partition-then-sort: partitions tuples on the top partition_bits key bits straight into
+// their final ranges of out, then LSD-radix-sorts every partition in place, one partition
+// per task. out ends up fully sorted with no merge step. scratch must hold tuple_count tuples.
+int run_partition_sort_timed(tuple_t *tuples, int tuple_count, int thread_count, int partition_bits,
+                             tuple_t *out, tuple_t *scratch, sort_result_t *result);
+
+// Single-threaded LSD radix sort of tuples into out (8 passes of 8 bits).
+int run_radix_sort_timed(tuple_t *tuples, int tuple_count, tuple_t *out, tuple_t *scratch, double *throughput);
+
+// qsort baseline; sorts out, which receives a copy of tuples.
+int run_qsort_timed(tuple_t *tuples, int tuple_count, tuple_t *out, double *throughput);
+
+// Returns 1 if the tuple_count keys of tuples are in non-decreasing order.
+int is_sorted_by_key(const tuple_t *tuples, int tuple_count);
+
+#endif
@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "sort.h"
+#include "project.h"
+#include "tuples.h"
+
+#define DEFAULT_TUPLE_BITS 24  // ~16 million tuples
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS> [LOG2_TUPLES] [BASELINES]\n", argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[1]);
+    int hash_bits = atoi(argv[2]);
+    int tuple_bits = argc > 3 ? atoi(argv[3]) : DEFAULT_TUPLE_BITS;
+    int baselines = argc > 4 ? atoi(argv[4]) : 1;
+    int tuple_count = 1 << tuple_bits;
+
+    tuple_t *tuples = generate_tuples(tuple_count);
+    tuple_t *out = malloc((size_t)tuple_count * sizeof(tuple_t));
+    tuple_t *scratch = malloc((size_t)tuple_count * sizeof(tuple_t));
+    if (!tuples || !out || !scratch) {
+        fprintf(stderr, "Error allocating %d tuples.\n", tuple_count);
+        free(tuples);
+        free(out);
+        free(scratch);
+        return -1;
+    }
+
+    sort_result_t result;
+    double radix_throughput = 0.0;
+    double qsort_throughput = 0.0;
+    if (run_partition_sort_timed(tuples, tuple_count, thread_count, hash_bits, out, scratch, &result) != 0) {
+        fprintf(stderr, "Error in partition sort with %d threads and %d hashbits\n", thread_count, hash_bits);
+    } else {
+        if (!is_sorted_by_key(out, tuple_count))
+            fprintf(stderr, "Partition sort output is not sorted\n");
+        // The baselines do not depend on the thread count or fan-out; BASELINES=0 skips them.
+        if (baselines) {
+            run_radix_sort_timed(tuples, tuple_count, out, scratch, &radix_throughput);
+            run_qsort_timed(tuples, tuple_count, out, &qsort_throughput);
+        }
+        printf("Threads,HashBits,Tuples,Throughput,PartitionMs,SortMs,RadixThroughput,QsortThroughput\n");
+        printf("%d,%d,%d,%.2f,%.1f,%.1f,%.2f,%.2f\n", thread_count, hash_bits, tuple_count, result.throughput,
+               result.partition_ms, result.sort_ms, radix_throughput, qsort_throughput);
+    }
+
+    free(tuples);
+    free(out);
+    free(scratch);
+    return 0;
+}
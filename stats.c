@@ -0,0 +1,132 @@
+#include "stats.h"
+#include "trace.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STATS_REGISTER_BUDGET_BITS 16  // 64 KiB of registers per thread.
+#define MIN_HLL_BITS 4
+#define MAX_HLL_BITS 12
+
+int stats_default_hll_bits(int hash_bits) {
+    int bits = STATS_REGISTER_BUDGET_BITS - hash_bits;
+    return bits < MIN_HLL_BITS ? MIN_HLL_BITS : bits > MAX_HLL_BITS ? MAX_HLL_BITS : bits;
+}
+
+int partition_stats_init(partition_stats_t *stats, int hash_bits, int fragment_count, int hll_bits) {
+    memset(stats, 0, sizeof(*stats));
+    // At least one hash bit must be left for the rank once the partition and register bits are taken.
+    if (hash_bits < 0 || fragment_count <= 0 || hll_bits < MIN_HLL_BITS || hll_bits > MAX_HLL_BITS ||
+        hash_bits + hll_bits > 31)
+        return -1;
+
+    stats->partition_count = 1 << hash_bits;
+    stats->hash_bits = hash_bits;
+    stats->fragment_count = fragment_count;
+    stats->hll_bits = hll_bits;
+    size_t slots = (size_t)fragment_count * stats->partition_count;
+    stats->summaries = malloc(slots * sizeof(partition_summary_t));
+    stats->registers = malloc(slots << hll_bits);
+    if (!stats->summaries || !stats->registers || pthread_barrier_init(&stats->barrier, NULL, fragment_count) != 0) {
+        free(stats->summaries);
+        free(stats->registers);
+        stats->summaries = NULL;
+        stats->registers = NULL;
+        return -1;
+    }
+    partition_stats_clear(stats);
+    return 0;
+}
+
+void partition_stats_free(partition_stats_t *stats) {
+    if (stats->summaries)
+        pthread_barrier_destroy(&stats->barrier);
+    free(stats->summaries);
+    free(stats->registers);
+    stats->summaries = NULL;
+    stats->registers = NULL;
+}
+
+void partition_stats_clear(partition_stats_t *stats) {
+    size_t slots = (size_t)stats->fragment_count * stats->partition_count;
+    for (size_t i = 0; i < slots; i++) {
+        stats->summaries[i].count = 0;
+        stats->summaries[i].min_key = UINT64_MAX;
+        stats->summaries[i].max_key = 0;
+    }
+    memset(stats->registers, 0, slots << stats->hll_bits);
+}
+
+void partition_stats_merge(partition_stats_t *stats, int fragment) {
+    if (stats->fragment_count == 1)
+        return;
+    pthread_barrier_wait(&stats->barrier);
+
+    TRACE_BEGIN("stats_merge");
+    int begin = (int)((long)stats->partition_count * fragment / stats->fragment_count);
+    int end = (int)((long)stats->partition_count * (fragment + 1) / stats->fragment_count);
+    size_t registers = (size_t)1 << stats->hll_bits;
+    for (int p = begin; p < end; p++) {
+        partition_summary_t *merged = &stats->summaries[p];
+        uint8_t *merged_registers = &stats->registers[(size_t)p << stats->hll_bits];
+        for (int f = 1; f < stats->fragment_count; f++) {
+            size_t slot = (size_t)f * stats->partition_count + p;
+            const partition_summary_t *local = &stats->summaries[slot];
+            merged->count += local->count;
+            merged->min_key = local->min_key < merged->min_key ? local->min_key : merged->min_key;
+            merged->max_key = local->max_key > merged->max_key ? local->max_key : merged->max_key;
+            const uint8_t *local_registers = &stats->registers[slot << stats->hll_bits];
+            for (size_t r = 0; r < registers; r++) {
+                if (local_registers[r] > merged_registers[r])
+                    merged_registers[r] = local_registers[r];
+            }
+        }
+    }
+    TRACE_END("stats_merge");
+}
+
+// Standard HyperLogLog estimate, switching to linear counting while registers are still empty.
+static double hll_estimate(const uint8_t *registers, int hll_bits) {
+    int m = 1 << hll_bits;
+    double alpha = m == 16 ? 0.673 : m == 32 ? 0.697 : m == 64 ? 0.709 : 0.7213 / (1.0 + 1.079 / m);
+    double sum = 0.0;
+    int zeros = 0;
+    for (int r = 0; r < m; r++) {
+        sum += ldexp(1.0, -registers[r]);
+        zeros += registers[r] == 0;
+    }
+    double estimate = alpha * m * m / sum;
+    if (estimate <= 2.5 * m && zeros > 0)
+        estimate = m * log((double)m / zeros);
+    return estimate;
+}
+
+void partition_stats_report(const partition_stats_t *stats, int partition, partition_report_t *report) {
+    const partition_summary_t *summary = &stats->summaries[partition];
+    report->count = summary->count;
+    report->min_key = summary->count ? summary->min_key : 0;
+    report->max_key = summary->count ? summary->max_key : 0;
+    report->distinct = summary->count ? hll_estimate(&stats->registers[(size_t)partition << stats->hll_bits],
+                                                     stats->hll_bits) : 0.0;
+}
+
+void partition_stats_print(const partition_stats_t *stats, FILE *out) {
+    size_t total = 0, largest = 0;
+    double distinct = 0.0;
+    uint64_t min_key = UINT64_MAX, max_key = 0;
+    for (int p = 0; p < stats->partition_count; p++) {
+        partition_report_t report;
+        partition_stats_report(stats, p, &report);
+        total += report.count;
+        distinct += report.distinct;
+        largest = report.count > largest ? report.count : largest;
+        if (report.count) {
+            min_key = report.min_key < min_key ? report.min_key : min_key;
+            max_key = report.max_key > max_key ? report.max_key : max_key;
+        }
+    }
+    double mean = (double)total / stats->partition_count;
+    fprintf(out, "Statistics: %zu tuples, ~%.0f distinct keys (%d HLL registers per partition), keys %#llx..%#llx, "
+            "largest partition %.2fx the mean\n", total, distinct, 1 << stats->hll_bits,
+            total ? (unsigned long long)min_key : 0ULL, (unsigned long long)max_key, mean > 0 ? largest / mean : 0.0);
+}
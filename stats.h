@@ -0,0 +1,88 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "utils.h"
+
+// Running summary of one partition: tuple count, key range (keys read with load_u64) and a
+// HyperLogLog sketch of its distinct keys.
+typedef struct {
+    size_t count;
+    uint64_t min_key;
+    uint64_t max_key;
+} partition_summary_t;
+
+// Statistics of one partitioning run, collected by the scatter loops. Like the Bloom filters,
+// every thread updates its own fragment and the fragments are merged into fragment 0 once all
+// threads are done, so reports read fragment 0.
+typedef struct partition_stats {
+    int partition_count;
+    int hash_bits;               // log2(partition_count): hash bits already spent on the partition id.
+    int fragment_count;
+    int hll_bits;                // log2 of the HLL registers per partition.
+    partition_summary_t *summaries;  // summaries[f * partition_count + p]
+    uint8_t *registers;              // registers[(f * partition_count + p) << hll_bits]
+    pthread_barrier_t barrier;
+} partition_stats_t;
+
+typedef struct {
+    size_t count;
+    uint64_t min_key;            // Both 0 for empty partitions.
+    uint64_t max_key;
+    double distinct;             // HyperLogLog estimate of the distinct keys.
+} partition_report_t;
+
+// HLL precision for a fan-out: registers shrink as partitions multiply (12 bits at low fan-outs,
+// down to 4), keeping a thread's sketches around 64 KiB so they stay cache-resident.
+int stats_default_hll_bits(int hash_bits);
+
+// Returns 0 on success, -1 on invalid arguments or allocation failure.
+int partition_stats_init(partition_stats_t *stats, int hash_bits, int fragment_count, int hll_bits);
+void partition_stats_free(partition_stats_t *stats);
+void partition_stats_clear(partition_stats_t *stats);
+
+// Same contract as bloom_set_merge: called by each fragment's thread after its last update.
+void partition_stats_merge(partition_stats_t *stats, int fragment);
+
+void partition_stats_report(const partition_stats_t *stats, int partition, partition_report_t *report);
+
+// Writes a one-line summary over all partitions: tuples, summed distinct estimates, key range and
+// the largest partition relative to the mean.
+void partition_stats_print(const partition_stats_t *stats, FILE *out);
+
+// One thread's fragment, unpacked into a value the scatter loops keep in registers.
+typedef struct {
+    partition_summary_t *summaries;
+    uint8_t *registers;
+    int hash_bits;
+    int hll_bits;
+} stats_fragment_t;
+
+static inline stats_fragment_t partition_stats_fragment(const partition_stats_t *stats, int fragment) {
+    size_t first = (size_t)fragment * stats->partition_count;
+    stats_fragment_t view = {stats->summaries + first, stats->registers + (first << stats->hll_bits),
+                             stats->hash_bits, stats->hll_bits};
+    return view;
+}
+
+// Folds a stored tuple with Murmur hash `hash` into the fragment's statistics for partition.
+// The sketch uses the hash bits above the partition id, so no second hash is needed.
+static inline void stats_fragment_add(stats_fragment_t view, int partition, uint32_t hash, const unsigned char *key) {
+    partition_summary_t *summary = &view.summaries[partition];
+    uint64_t k = load_u64(key);
+    summary->min_key = k < summary->min_key ? k : summary->min_key;
+    summary->max_key = k > summary->max_key ? k : summary->max_key;
+    summary->count++;
+
+    uint32_t rest = hash >> view.hash_bits;
+    uint32_t index = rest & ((1U << view.hll_bits) - 1);
+    uint32_t w = (rest >> view.hll_bits) | (1U << (32 - view.hash_bits - view.hll_bits));  // Sentinel caps the rank.
+    uint8_t rank = (uint8_t)(__builtin_ctz(w) + 1);
+    uint8_t *reg = &view.registers[((size_t)partition << view.hll_bits) + index];
+    *reg = rank > *reg ? rank : *reg;
+}
+
+#endif
@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "libpartition.h"
+#include "project.h"
+#include "utils.h"
+#include "tuples.h"
+
+#define TUPLE_COUNT (1 << 24)  // ~16 million tuples
+#define DEFAULT_BATCH_SIZE 4096
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static int count_tuples(int partition, const tuple_t *tuples, int count, void *ctx) {
+    (void)partition;
+    (void)tuples;
+    *(long *)ctx += count;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS> [independent|concurrent] [BATCH_SIZE]\n", argv[0]);
+        return -1;
+    }
+    partitioner_config_t config = {PARTITIONER_INDEPENDENT, atoi(argv[1]), atoi(argv[2])};
+    if (argc > 3 && strcmp(argv[3], "concurrent") == 0) {
+        config.strategy = PARTITIONER_CONCURRENT;
+    } else if (argc > 3 && strcmp(argv[3], "independent") != 0) {
+        fprintf(stderr, "Unknown strategy '%s'.\n", argv[3]);
+        return -1;
+    }
+    int batch_size = argc > 4 ? atoi(argv[4]) : DEFAULT_BATCH_SIZE;
+    if (batch_size <= 0) {
+        fprintf(stderr, "Batch size must be positive.\n");
+        return -1;
+    }
+
+    // Generate tuples.
+    tuple_t *tuples = generate_tuples(TUPLE_COUNT);
+    if (!tuples) {
+        fprintf(stderr, "Error generating tuples.\n");
+        return -1;
+    }
+
+    int batch_count = (TUPLE_COUNT + batch_size - 1) / batch_size;
+    double *latencies = malloc(batch_count * sizeof(double));
+    partitioner_t *partitioner = partitioner_create(&config);
+    if (!latencies || !partitioner) {
+        fprintf(stderr, "Error creating partitioner.\n");
+        free(tuples);
+        free(latencies);
+        return -1;
+    }
+
+    // Feed the input batch by batch, timing each push.
+    struct timespec start, end, batch_start, batch_end;
+    int status = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int b = 0; b < batch_count && status == 0; b++) {
+        int offset = b * batch_size;
+        int count = offset + batch_size > TUPLE_COUNT ? TUPLE_COUNT - offset : batch_size;
+        clock_gettime(CLOCK_MONOTONIC, &batch_start);
+        status = partitioner_push_batch(partitioner, tuples + offset, count);
+        clock_gettime(CLOCK_MONOTONIC, &batch_end);
+        latencies[b] = elapsed_ms(&batch_start, &batch_end) * 1000.0;
+    }
+    long stored = partitioner_flush(partitioner);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    long visited = 0;
+    partitioner_iterate_partitions(partitioner, count_tuples, &visited);
+    if (status != 0 || stored != TUPLE_COUNT || visited != TUPLE_COUNT) {
+        fprintf(stderr, "Streaming run lost tuples (stored %ld, visited %ld of %d).\n", stored, visited, TUPLE_COUNT);
+    } else {
+        // Sustained throughput covers the whole stream; latencies are per push in microseconds.
+        double throughput = TUPLE_COUNT / (elapsed_ms(&start, &end) * 1000.0);
+        qsort(latencies, batch_count, sizeof(double), compare_doubles);
+        printf("Threads,HashBits,Strategy,BatchSize,Throughput,P50Us,P99Us,MaxUs\n");
+        printf("%d,%d,%s,%d,%.2f,%.2f,%.2f,%.2f\n", config.thread_count, config.hash_bits,
+               config.strategy == PARTITIONER_CONCURRENT ? "concurrent" : "independent", batch_size, throughput,
+               latencies[batch_count / 2], latencies[(int)(batch_count * 0.99)], latencies[batch_count - 1]);
+    }
+
+    partitioner_destroy(partitioner);
+    free(latencies);
+    free(tuples);
+    return 0;
+}
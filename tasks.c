@@ -0,0 +1,66 @@
+#define _GNU_SOURCE
+#include "tasks.h"
+#include "affinity.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+    int worker_id;
+    int task_count;
+    int *next_task;  // Shared claim counter.
+    task_fn fn;
+    void *ctx;
+} worker_args_t;
+
+static void *task_worker(void *void_args) {
+    worker_args_t *args = (worker_args_t *)void_args;
+
+    set_affinity(args->worker_id + 1);
+
+    for (;;) {
+        int task = __atomic_fetch_add(args->next_task, 1, __ATOMIC_RELAXED);
+        if (task >= args->task_count)
+            break;
+        args->fn(task, args->worker_id, args->ctx);
+    }
+    return NULL;
+}
+
+int run_tasks(int thread_count, int task_count, task_fn fn, void *ctx) {
+    if (thread_count <= 0 || !fn)
+        return -1;
+
+    pthread_t *threads = malloc(thread_count * sizeof(pthread_t));
+    worker_args_t *args = malloc(thread_count * sizeof(worker_args_t));
+    if (!threads || !args) {
+        fprintf(stderr, "Error allocating memory for task workers.\n");
+        free(threads);
+        free(args);
+        return -1;
+    }
+
+    int next_task = 0;
+    int created = 0;
+    for (int i = 0; i < thread_count; i++) {
+        args[i].worker_id = i;
+        args[i].task_count = task_count;
+        args[i].next_task = &next_task;
+        args[i].fn = fn;
+        args[i].ctx = ctx;
+        if (pthread_create(&threads[i], NULL, task_worker, &args[i]) != 0) {
+            fprintf(stderr, "Error creating task worker %d\n", i);
+            break;
+        }
+        created++;
+    }
+
+    // Workers that did start drain the remaining tasks even if creation failed part way.
+    for (int i = 0; i < created; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(threads);
+    free(args);
+    return created == thread_count ? 0 : -1;
+}
@@ -0,0 +1,12 @@
+#ifndef TASKS_H
+#define TASKS_H
+
+// Task body: called once per task id, on the worker identified by worker_id (0-based).
+typedef void (*task_fn)(int task_id, int worker_id, void *ctx);
+
+// Runs task_count tasks on thread_count pthreads. Workers claim task ids dynamically
+// from a shared counter, so uneven tasks (e.g. skewed partitions) balance out.
+// Returns 0 on success, -1 on error.
+int run_tasks(int thread_count, int task_count, task_fn fn, void *ctx);
+
+#endif
@@ -0,0 +1,126 @@
+#include "trace.h"
+
+#ifdef TRACING
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    const char *name;   // Static string passed to the probe.
+    uint64_t ts_ns;
+    uint64_t dur_ns;    // Complete ('X') events only.
+    char phase;
+} trace_event_t;
+
+typedef struct trace_ring {
+    struct trace_ring *next;
+    int tid;
+    uint64_t count;     // Events ever recorded; the ring holds the last TRACE_RING_EVENTS.
+    uint64_t wait_ns;   // Total time spent waiting for contended locks.
+    trace_event_t events[TRACE_RING_EVENTS];
+} trace_ring_t;
+
+int trace_enabled = 0;
+
+static const char *trace_path;
+static trace_ring_t *rings;
+static int next_tid;
+static pthread_mutex_t rings_mutex = PTHREAD_MUTEX_INITIALIZER;
+static __thread trace_ring_t *thread_ring;
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Rings are registered on a thread's first event and kept until exit, after the thread is gone.
+static trace_ring_t *get_ring(void) {
+    if (thread_ring)
+        return thread_ring;
+    trace_ring_t *ring = calloc(1, sizeof(trace_ring_t));
+    if (!ring)
+        return NULL;
+    pthread_mutex_lock(&rings_mutex);
+    ring->tid = next_tid++;
+    ring->next = rings;
+    rings = ring;
+    pthread_mutex_unlock(&rings_mutex);
+    thread_ring = ring;
+    return ring;
+}
+
+static void push_event(trace_ring_t *ring, const char *name, char phase, uint64_t ts_ns, uint64_t dur_ns) {
+    trace_event_t *event = &ring->events[ring->count++ & (TRACE_RING_EVENTS - 1)];
+    event->name = name;
+    event->phase = phase;
+    event->ts_ns = ts_ns;
+    event->dur_ns = dur_ns;
+}
+
+void trace_record(const char *name, char phase) {
+    trace_ring_t *ring = get_ring();
+    if (ring)
+        push_event(ring, name, phase, now_ns(), 0);
+}
+
+void trace_lock_slow(pthread_mutex_t *mutex) {
+    if (pthread_mutex_trylock(mutex) == 0)
+        return;
+    uint64_t start = now_ns();
+    pthread_mutex_lock(mutex);
+    uint64_t wait = now_ns() - start;
+    trace_ring_t *ring = get_ring();
+    if (!ring)
+        return;
+    ring->wait_ns += wait;
+    if (wait >= TRACE_MIN_WAIT_NS)
+        push_event(ring, "mutex_wait", 'X', start, wait);
+}
+
+static void write_trace(void) {
+    trace_enabled = 0;
+    FILE *out = fopen(trace_path, "w");
+    if (!out) {
+        perror(trace_path);
+        return;
+    }
+    int pid = (int)getpid();
+    int first = 1;
+    fprintf(out, "{\"traceEvents\":[\n");
+    pthread_mutex_lock(&rings_mutex);
+    for (trace_ring_t *ring = rings; ring; ring = ring->next) {
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                     "\"args\":{\"name\":\"thread %d (mutex wait %.3f ms)\"}}",
+                first ? "" : ",\n", pid, ring->tid, ring->tid, ring->wait_ns / 1e6);
+        first = 0;
+        uint64_t begin = ring->count > TRACE_RING_EVENTS ? ring->count - TRACE_RING_EVENTS : 0;
+        for (uint64_t i = begin; i < ring->count; i++) {
+            const trace_event_t *event = &ring->events[i & (TRACE_RING_EVENTS - 1)];
+            fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f", event->name,
+                    event->phase, pid, ring->tid, event->ts_ns / 1e3);
+            if (event->phase == 'X')
+                fprintf(out, ",\"dur\":%.3f", event->dur_ns / 1e3);
+            fprintf(out, "}");
+        }
+    }
+    fprintf(out, "\n]}\n");
+    while (rings) {
+        trace_ring_t *next = rings->next;
+        free(rings);
+        rings = next;
+    }
+    pthread_mutex_unlock(&rings_mutex);
+    fclose(out);
+}
+
+__attribute__((constructor)) static void trace_init(void) {
+    trace_path = getenv("PARTITION_TRACE");
+    if (trace_path && *trace_path && atexit(write_trace) == 0)
+        trace_enabled = 1;
+}
+
+#endif
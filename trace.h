@@ -0,0 +1,50 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <pthread.h>
+
+// Per-thread timeline tracing, exported as Chrome trace JSON (chrome://tracing, Perfetto).
+// Compiled in with -DTRACING (make TRACE=1) and switched on at run time by naming the output
+// file in PARTITION_TRACE. Compiled in but disabled, each probe is a single predictable branch;
+// compiled out, the probes disappear and TRACE_LOCK is a plain pthread_mutex_lock.
+//
+// Each thread records begin/end events into its own ring of TRACE_RING_EVENTS (the oldest
+// events are overwritten), so probes never contend. The trace is written at process exit.
+
+#define TRACE_RING_EVENTS (1 << 16)
+// Lock waits shorter than this only count towards the thread's total wait time.
+#define TRACE_MIN_WAIT_NS 1000
+
+#ifdef TRACING
+
+extern int trace_enabled;
+
+void trace_record(const char *name, char phase);
+void trace_lock_slow(pthread_mutex_t *mutex);
+
+static inline void trace_event(const char *name, char phase) {
+    if (__builtin_expect(trace_enabled, 0))
+        trace_record(name, phase);
+}
+
+// Locks mutex; when tracing, a contended acquisition is recorded as a "mutex_wait" event.
+static inline void trace_lock(pthread_mutex_t *mutex) {
+    if (__builtin_expect(trace_enabled, 0))
+        trace_lock_slow(mutex);
+    else
+        pthread_mutex_lock(mutex);
+}
+
+#define TRACE_BEGIN(name) trace_event(name, 'B')
+#define TRACE_END(name) trace_event(name, 'E')
+#define TRACE_LOCK(mutex) trace_lock(mutex)
+
+#else
+
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name) ((void)0)
+#define TRACE_LOCK(mutex) pthread_mutex_lock(mutex)
+
+#endif
+
+#endif
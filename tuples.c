@@ -4,12 +4,11 @@
 #include <unistd.h>
 #include <errno.h>
 #include "tuples.h"  
+#include "trace.h"
 
-// Generate tuples (16 bytes per tuple)
-tuple_t *generate_tuples(int count) {
-    if (count <= 0 || count > MAX_TUPLES)
-        return NULL;
-    size_t total_bytes = count * 16;
+// Fills count tuples from /dev/urandom.
+static tuple_t *read_random_tuples(size_t count) {
+    size_t total_bytes = count * sizeof(tuple_t);
     unsigned char *buffer = malloc(total_bytes);
     if (!buffer)
         return NULL;
@@ -35,3 +34,13 @@ tuple_t *generate_tuples(int count) {
     close(fd);
     return (tuple_t *)buffer;
 }
+
+// Generate tuples (16 bytes per tuple)
+tuple_t *generate_tuples(size_t count) {
+    if (count == 0 || count > MAX_TUPLES)
+        return NULL;
+    TRACE_BEGIN("generate");
+    tuple_t *tuples = read_random_tuples(count);
+    TRACE_END("generate");
+    return tuples;
+}
@@ -4,6 +4,6 @@
 #include "project.h"
 
 // Declaration of generate_tuples.
-tuple_t *generate_tuples(int count);
+tuple_t *generate_tuples(size_t count);
 
 #endif
@@ -1,8 +1,10 @@
 #include "utils.h"
+#include "project.h"
 #include <time.h>
 #include <stdint.h>
 #include <string.h>
 #include <math.h>
+#include <stdlib.h>
 
 // A simple MurmurHash3 32-bit implementation for an 8-byte key.
 uint32_t murmurhash3_32(const void *key, int len, uint32_t seed) {
@@ -13,9 +15,11 @@ uint32_t murmurhash3_32(const void *key, int len, uint32_t seed) {
     const uint32_t c1 = 0xcc9e2d51;
     const uint32_t c2 = 0x1b873593;
     
-    const uint32_t *blocks = (const uint32_t *)data;
+    // Blocks are loaded with memcpy: keys need not be 4-byte aligned (variable-length records
+    // place them right after a 2-byte length).
     for (int i = 0; i < nblocks; i++) {
-        uint32_t k1 = blocks[i];
+        uint32_t k1;
+        memcpy(&k1, data + i * 4, sizeof(k1));
         k1 *= c1;
         k1 = (k1 << 15) | (k1 >> (32 - 15));
         k1 *= c2;
@@ -47,7 +51,24 @@ uint32_t murmurhash3_32(const void *key, int len, uint32_t seed) {
     return h1;
 }
 
+uint32_t hash_key(const unsigned char *key) {
+    return murmurhash3_32(key, 8, 42);
+}
+
 int hash_to_partition(const unsigned char *key, int partition_count) {
-    uint32_t hash = murmurhash3_32(key, 8, 42);
+    uint32_t hash = hash_key(key);
     return (int)(hash % partition_count);
 }
+
+double elapsed_ms(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) * 1000.0 + (end->tv_nsec - start->tv_nsec) / 1e6;
+}
+
+int parse_log2_tuples(const char *arg, size_t *tuple_count) {
+    char *end;
+    long log2 = strtol(arg, &end, 10);
+    if (end == arg || *end != '\0' || log2 < 0 || log2 >= 64 || ((size_t)1 << log2) > MAX_TUPLES)
+        return -1;
+    *tuple_count = (size_t)1 << log2;
+    return 0;
+}
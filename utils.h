@@ -2,8 +2,37 @@
 #define UTILS_H
 
 #include <stdint.h>
+#include <string.h>
+#include <time.h>
 #include "project.h"
 
+uint32_t murmurhash3_32(const void *key, int len, uint32_t seed);
+
+// 32-bit hash of an 8-byte key. Partition ids are taken from its low bits, so
+// downstream stages use the remaining high bits.
+uint32_t hash_key(const unsigned char *key);
+
 int hash_to_partition(const unsigned char *key, int partition_count);
 
+// Bucket index from the hash bits left over after partitioning. Rotating keeps all
+// 32 bits usable when hash_bits plus the table bits exceed the hash width.
+static inline uint32_t hash_bucket(uint32_t hash, int hash_bits, uint32_t mask) {
+    uint32_t rotated = hash_bits ? (hash >> hash_bits) | (hash << (32 - hash_bits)) : hash;
+    return rotated & mask;
+}
+
+// Reads an 8-byte key or value as a native-endian integer.
+static inline uint64_t load_u64(const unsigned char *bytes) {
+    uint64_t v;
+    memcpy(&v, bytes, sizeof(v));
+    return v;
+}
+
+// Milliseconds elapsed between two timestamps.
+double elapsed_ms(const struct timespec *start, const struct timespec *end);
+
+// Parses a tuple count given as its log2 (e.g. "32" for 2^32 tuples), up to MAX_TUPLES.
+// Returns 0 on success, -1 on malformed or out-of-range values.
+int parse_log2_tuples(const char *arg, size_t *tuple_count);
+
 #endif
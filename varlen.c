@@ -0,0 +1,302 @@
+#include "project.h"
+#include "utils.h"
+#include "tasks.h"
+#include "trace.h"
+#include "varlen.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define VARLEN_SEED 0x9E3779B97F4A7C15ULL
+
+typedef struct {
+    const varlen_batch_t *input;
+    int thread_count;
+    int partition_count;
+    strategy_t strategy;
+    uint32_t *record_partitions;  // Partition of every input record, from the first pass.
+    size_t *counts;               // Records per thread and partition: counts[t * partition_count + p].
+    uint64_t *bytes;              // Record bytes per thread and partition, same layout.
+    size_t *cursors;              // Next record slot per fragment and partition.
+    uint64_t *heap_cursors;       // Next free heap byte per fragment and partition.
+    pthread_mutex_t *mutexes;     // Concurrent: one per partition.
+    varlen_partitions_t *out;
+} varlen_ctx_t;
+
+int parse_varlen_dist(const char *name, varlen_dist_t *dist) {
+    if (strcmp(name, "short") == 0) {
+        *dist = VARLEN_SHORT;
+        return 0;
+    }
+    if (strcmp(name, "uniform") == 0) {
+        *dist = VARLEN_UNIFORM;
+        return 0;
+    }
+    if (strcmp(name, "skewed") == 0) {
+        *dist = VARLEN_SKEWED;
+        return 0;
+    }
+    return -1;
+}
+
+const char *varlen_dist_name(varlen_dist_t dist) {
+    switch (dist) {
+        case VARLEN_UNIFORM: return "uniform";
+        case VARLEN_SKEWED: return "skewed";
+        default: return "short";
+    }
+}
+
+static inline uint64_t xorshift64(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+// Key and payload lengths of one record drawn from dist.
+static void draw_lengths(varlen_dist_t dist, uint64_t *state, size_t *key_len, size_t *payload_len) {
+    uint64_t r = xorshift64(state);
+    switch (dist) {
+        case VARLEN_UNIFORM:
+            *key_len = 8 + r % 57;
+            *payload_len = (r >> 16) % 257;
+            break;
+        case VARLEN_SKEWED: {
+            // Geometric size class: half the payloads are 8..15 bytes, each class after that is
+            // twice as long and half as likely, capped at 8..16 KiB.
+            int size_class = __builtin_ctzll(r | (1ULL << 10));
+            size_t base = (size_t)8 << size_class;
+            *key_len = 8 + (r >> 16) % 25;
+            *payload_len = base + (r >> 32) % base;
+            break;
+        }
+        default:
+            *key_len = 8;
+            *payload_len = 8;
+            break;
+    }
+}
+
+static void fill_random(unsigned char *dst, size_t len, uint64_t *state) {
+    while (len >= 8) {
+        uint64_t r = xorshift64(state);
+        memcpy(dst, &r, 8);
+        dst += 8;
+        len -= 8;
+    }
+    if (len > 0) {
+        uint64_t r = xorshift64(state);
+        memcpy(dst, &r, len);
+    }
+}
+
+int varlen_generate(varlen_batch_t *batch, size_t count, varlen_dist_t dist) {
+    memset(batch, 0, sizeof(*batch));
+    batch->offsets = malloc((count + 1) * sizeof(uint64_t));
+    if (!batch->offsets)
+        return -1;
+
+    // Lengths first, so the heap can be allocated in one piece.
+    uint64_t state = VARLEN_SEED;
+    batch->offsets[0] = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t key_len, payload_len;
+        draw_lengths(dist, &state, &key_len, &payload_len);
+        batch->offsets[i + 1] = batch->offsets[i] + VARLEN_HEADER_BYTES + key_len + payload_len;
+    }
+    batch->heap = malloc(batch->offsets[count]);
+    if (!batch->heap) {
+        varlen_batch_free(batch);
+        return -1;
+    }
+    batch->count = count;
+
+    state = VARLEN_SEED;
+    uint64_t content_state = VARLEN_SEED ^ count;
+    for (size_t i = 0; i < count; i++) {
+        size_t key_len, payload_len;
+        draw_lengths(dist, &state, &key_len, &payload_len);
+        unsigned char *record = batch->heap + batch->offsets[i];
+        record[0] = (unsigned char)(key_len & 0xFF);
+        record[1] = (unsigned char)(key_len >> 8);
+        fill_random(record + VARLEN_HEADER_BYTES, key_len + payload_len, &content_state);
+    }
+    return 0;
+}
+
+void varlen_batch_free(varlen_batch_t *batch) {
+    free(batch->offsets);
+    free(batch->heap);
+    memset(batch, 0, sizeof(*batch));
+}
+
+void varlen_partitions_free(varlen_partitions_t *out) {
+    free(out->parts);
+    free(out->offset_block);
+    free(out->heap_block);
+    memset(out, 0, sizeof(*out));
+}
+
+static void slice_bounds(const varlen_ctx_t *ctx, int task_id, size_t *begin, size_t *end) {
+    size_t base = ctx->input->count / ctx->thread_count;
+    *begin = (size_t)task_id * base;
+    *end = task_id == ctx->thread_count - 1 ? ctx->input->count : *begin + base;
+}
+
+static void count_slice(int task_id, int worker_id, void *arg) {
+    (void)worker_id;
+    varlen_ctx_t *ctx = (varlen_ctx_t *)arg;
+    const varlen_batch_t *input = ctx->input;
+    size_t *counts = ctx->counts + (size_t)task_id * ctx->partition_count;
+    uint64_t *bytes = ctx->bytes + (size_t)task_id * ctx->partition_count;
+    size_t begin, end;
+    slice_bounds(ctx, task_id, &begin, &end);
+
+    TRACE_BEGIN("histogram");
+    for (size_t i = begin; i < end; i++) {
+        const unsigned char *record = input->heap + input->offsets[i];
+        uint32_t hash = murmurhash3_32(varlen_key(record), varlen_key_length(record), 42);
+        uint32_t p = hash % (uint32_t)ctx->partition_count;
+        ctx->record_partitions[i] = p;
+        counts[p]++;
+        bytes[p] += input->offsets[i + 1] - input->offsets[i];
+    }
+    TRACE_END("histogram");
+}
+
+static void scatter_slice(int task_id, int worker_id, void *arg) {
+    (void)worker_id;
+    varlen_ctx_t *ctx = (varlen_ctx_t *)arg;
+    const varlen_batch_t *input = ctx->input;
+    int concurrent = ctx->strategy == STRATEGY_CONCURRENT;
+    size_t fragment = concurrent ? 0 : (size_t)task_id * ctx->partition_count;
+    varlen_batch_t *parts = ctx->out->parts + fragment;
+    size_t *cursors = ctx->cursors + fragment;
+    uint64_t *heap_cursors = ctx->heap_cursors + fragment;
+    size_t begin, end;
+    slice_bounds(ctx, task_id, &begin, &end);
+
+    TRACE_BEGIN("scatter");
+    for (size_t i = begin; i < end; i++) {
+        uint32_t p = ctx->record_partitions[i];
+        uint64_t len = input->offsets[i + 1] - input->offsets[i];
+        size_t idx;
+        uint64_t pos;
+        if (concurrent) {
+            // Only the reservation is serialized; the copy runs outside the lock.
+            TRACE_LOCK(&ctx->mutexes[p]);
+            idx = cursors[p]++;
+            pos = heap_cursors[p];
+            heap_cursors[p] = pos + len;
+            pthread_mutex_unlock(&ctx->mutexes[p]);
+        } else {
+            idx = cursors[p]++;
+            pos = heap_cursors[p];
+            heap_cursors[p] = pos + len;
+        }
+        parts[p].offsets[idx] = pos;
+        memcpy(parts[p].heap + pos, input->heap + input->offsets[i], len);
+    }
+    TRACE_END("scatter");
+}
+
+// Points every output batch at its slice of the backing blocks, using the first pass counts.
+static void layout_partitions(varlen_ctx_t *ctx) {
+    varlen_partitions_t *out = ctx->out;
+    int partition_count = ctx->partition_count;
+    size_t offset_pos = 0;
+    uint64_t heap_pos = 0;
+    for (int f = 0; f < out->fragment_count; f++) {
+        for (int p = 0; p < partition_count; p++) {
+            size_t count = 0;
+            uint64_t bytes = 0;
+            if (ctx->strategy == STRATEGY_CONCURRENT) {
+                for (int t = 0; t < ctx->thread_count; t++) {
+                    count += ctx->counts[(size_t)t * partition_count + p];
+                    bytes += ctx->bytes[(size_t)t * partition_count + p];
+                }
+            } else {
+                count = ctx->counts[(size_t)f * partition_count + p];
+                bytes = ctx->bytes[(size_t)f * partition_count + p];
+            }
+            varlen_batch_t *part = &out->parts[(size_t)f * partition_count + p];
+            part->count = count;
+            part->offsets = out->offset_block + offset_pos;
+            part->heap = out->heap_block + heap_pos;
+            part->offsets[count] = bytes;
+            offset_pos += count + 1;
+            heap_pos += bytes;
+        }
+    }
+}
+
+int run_varlen_timed(const varlen_batch_t *input, int thread_count, int hash_bits, strategy_t strategy,
+                     varlen_partitions_t *out, double *throughput, double *bandwidth) {
+    if (!input || !out || !throughput || !bandwidth || thread_count <= 0 || hash_bits < 0 || hash_bits > 24)
+        return -1;
+
+    int partition_count = 1 << hash_bits;
+    memset(out, 0, sizeof(*out));
+    out->strategy = strategy;
+    out->partition_count = partition_count;
+    out->fragment_count = strategy == STRATEGY_INDEPENDENT ? thread_count : 1;
+
+    // Total sizes are known up front, so all output is allocated before the clock starts.
+    size_t buffer_count = (size_t)out->fragment_count * partition_count;
+    size_t slot_count = (size_t)thread_count * partition_count;
+    uint64_t heap_bytes = input->offsets[input->count] - input->offsets[0];
+    varlen_ctx_t ctx = {input, thread_count, partition_count, strategy, NULL, NULL, NULL, NULL, NULL, NULL, out};
+    int ret = -1, mutexes_ready = 0;
+    out->parts = calloc(buffer_count, sizeof(varlen_batch_t));
+    out->offset_block = malloc((input->count + buffer_count) * sizeof(uint64_t));
+    out->heap_block = malloc(heap_bytes > 0 ? heap_bytes : 1);
+    ctx.record_partitions = malloc((input->count > 0 ? input->count : 1) * sizeof(uint32_t));
+    ctx.counts = calloc(slot_count, sizeof(size_t));
+    ctx.bytes = calloc(slot_count, sizeof(uint64_t));
+    ctx.cursors = calloc(buffer_count, sizeof(size_t));
+    ctx.heap_cursors = calloc(buffer_count, sizeof(uint64_t));
+    if (strategy == STRATEGY_CONCURRENT)
+        ctx.mutexes = malloc(partition_count * sizeof(pthread_mutex_t));
+    if (!out->parts || !out->offset_block || !out->heap_block || !ctx.record_partitions || !ctx.counts ||
+        !ctx.bytes || !ctx.cursors || !ctx.heap_cursors || (strategy == STRATEGY_CONCURRENT && !ctx.mutexes)) {
+        fprintf(stderr, "Error allocating variable-length partitions.\n");
+        goto out;
+    }
+    if (ctx.mutexes) {
+        for (int p = 0; p < partition_count; p++)
+            pthread_mutex_init(&ctx.mutexes[p], NULL);
+        mutexes_ready = 1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &start);
+    if (run_tasks(thread_count, thread_count, count_slice, &ctx) != 0)
+        goto out;
+    layout_partitions(&ctx);
+    if (run_tasks(thread_count, thread_count, scatter_slice, &ctx) != 0)
+        goto out;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &end);
+
+    double seconds = elapsed_ms(&start, &end) / 1000.0;
+    *throughput = ((double)input->count / seconds) / 1e6;
+    *bandwidth = ((double)heap_bytes / seconds) / 1e9;
+    ret = 0;
+
+out:
+    if (mutexes_ready)
+        for (int p = 0; p < partition_count; p++)
+            pthread_mutex_destroy(&ctx.mutexes[p]);
+    free(ctx.mutexes);
+    free(ctx.record_partitions);
+    free(ctx.counts);
+    free(ctx.bytes);
+    free(ctx.cursors);
+    free(ctx.heap_cursors);
+    if (ret != 0)
+        varlen_partitions_free(out);
+    return ret;
+}
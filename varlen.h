@@ -0,0 +1,63 @@
+#ifndef VARLEN_H
+#define VARLEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "partitions.h"
+
+// Variable-length records: record i occupies heap[offsets[i], offsets[i + 1]) and is laid out
+// as a little-endian uint16 key length, the key bytes, then the payload. Records are hashed
+// with Murmur over the full key bytes (hash_key for 8-byte keys gives the same partitions).
+typedef struct {
+    size_t count;
+    uint64_t *offsets;      // count + 1 entries.
+    unsigned char *heap;
+} varlen_batch_t;
+
+#define VARLEN_HEADER_BYTES 2
+
+static inline uint16_t varlen_key_length(const unsigned char *record) {
+    return (uint16_t)(record[0] | (record[1] << 8));
+}
+
+static inline const unsigned char *varlen_key(const unsigned char *record) {
+    return record + VARLEN_HEADER_BYTES;
+}
+
+// Length distributions for generated input.
+typedef enum {
+    VARLEN_SHORT,    // 8-byte keys, 8-byte payloads: tuple_t with a length header.
+    VARLEN_UNIFORM,  // Keys of 8..64 bytes, payloads of 0..256 bytes, uniformly.
+    VARLEN_SKEWED,   // Keys of 8..32 bytes; payloads mostly under 64 bytes with a tail up to 16 KiB.
+} varlen_dist_t;
+
+int parse_varlen_dist(const char *name, varlen_dist_t *dist);
+const char *varlen_dist_name(varlen_dist_t dist);
+
+// Generates count random records. Returns 0 on success, -1 on allocation failure.
+int varlen_generate(varlen_batch_t *batch, size_t count, varlen_dist_t dist);
+void varlen_batch_free(varlen_batch_t *batch);
+
+// Partitioned output: partition p is made of fragment_count batches parts[f * partition_count + p]
+// (one fragment per thread for the independent strategy, one shared fragment for the
+// concurrent one), whose offsets and heaps point into the backing blocks.
+typedef struct {
+    strategy_t strategy;
+    int partition_count;
+    int fragment_count;
+    varlen_batch_t *parts;
+    uint64_t *offset_block;
+    unsigned char *heap_block;
+} varlen_partitions_t;
+
+void varlen_partitions_free(varlen_partitions_t *out);
+
+// Partitions input into 2^hash_bits partitions in two passes: the first hashes every record
+// and counts records and bytes per partition, so the second can copy each record straight to
+// its final place. Independent: each thread fills private per-partition heaps. Concurrent:
+// all threads share one heap per partition and reserve slots under its mutex.
+// throughput is in million records/s, bandwidth in GB/s of record bytes.
+int run_varlen_timed(const varlen_batch_t *input, int thread_count, int hash_bits, strategy_t strategy,
+                     varlen_partitions_t *out, double *throughput, double *bandwidth);
+
+#endif
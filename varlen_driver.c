@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "partitions.h"
+#include "project.h"
+#include "utils.h"
+#include "varlen.h"
+
+#define DEFAULT_RECORD_COUNT ((size_t)1 << 22)  // ~4 million records; uniform lengths average ~170 bytes.
+
+// Order-independent fingerprint of a record's bytes, to check that the output holds the input.
+static uint64_t fingerprint(const unsigned char *record, uint64_t len) {
+    return murmurhash3_32(record, (int)len, 7) * 0x9E3779B97F4A7C15ULL + len;
+}
+
+// Checks that every input record landed exactly once, in the partition its key hashes to.
+static int verify(const varlen_batch_t *input, const varlen_partitions_t *out) {
+    uint64_t expected = 0, found = 0;
+    for (size_t i = 0; i < input->count; i++)
+        expected += fingerprint(input->heap + input->offsets[i], input->offsets[i + 1] - input->offsets[i]);
+
+    size_t records = 0;
+    for (int f = 0; f < out->fragment_count; f++) {
+        for (int p = 0; p < out->partition_count; p++) {
+            const varlen_batch_t *part = &out->parts[(size_t)f * out->partition_count + p];
+            records += part->count;
+            for (size_t j = 0; j < part->count; j++) {
+                const unsigned char *record = part->heap + part->offsets[j];
+                uint32_t hash = murmurhash3_32(varlen_key(record), varlen_key_length(record), 42);
+                if ((int)(hash % (uint32_t)out->partition_count) != p) {
+                    fprintf(stderr, "Record in the wrong partition %d.\n", p);
+                    return -1;
+                }
+                found += fingerprint(record, part->offsets[j + 1] - part->offsets[j]);
+            }
+        }
+    }
+    if (records != input->count || found != expected) {
+        fprintf(stderr, "Partitioned records do not match the input.\n");
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <THREAD_COUNT> <HASHBITS> [independent|concurrent] [short|uniform|skewed] "
+                "[LOG2_RECORDS]\n", argv[0]);
+        return -1;
+    }
+    int thread_count = atoi(argv[1]);
+    int hash_bits = atoi(argv[2]);
+    strategy_t strategy = STRATEGY_INDEPENDENT;
+    varlen_dist_t dist = VARLEN_UNIFORM;
+    size_t record_count = DEFAULT_RECORD_COUNT;
+    if (argc > 3 && parse_strategy(argv[3], &strategy) != 0) {
+        fprintf(stderr, "Unknown strategy '%s'.\n", argv[3]);
+        return -1;
+    }
+    if (argc > 4 && parse_varlen_dist(argv[4], &dist) != 0) {
+        fprintf(stderr, "Unknown length distribution '%s'.\n", argv[4]);
+        return -1;
+    }
+    if (argc > 5 && parse_log2_tuples(argv[5], &record_count) != 0) {
+        fprintf(stderr, "Invalid record count '%s' (log2, at most 2^36).\n", argv[5]);
+        return -1;
+    }
+
+    varlen_batch_t input;
+    if (varlen_generate(&input, record_count, dist) != 0) {
+        fprintf(stderr, "Error generating records.\n");
+        return -1;
+    }
+
+    varlen_partitions_t out;
+    double throughput, bandwidth;
+    int status = run_varlen_timed(&input, thread_count, hash_bits, strategy, &out, &throughput, &bandwidth);
+    if (status == 0) {
+        status = verify(&input, &out);
+        if (status == 0) {
+            // Throughput in million records/s, bandwidth in GB/s of record bytes.
+            printf("Threads,HashBits,Strategy,Distribution,AvgBytes,Throughput,Bandwidth\n");
+            printf("%d,%d,%s,%s,%.1f,%.2f,%.2f\n", thread_count, hash_bits, strategy_name(strategy),
+                   varlen_dist_name(dist), (double)input.offsets[input.count] / input.count, throughput, bandwidth);
+        }
+        varlen_partitions_free(&out);
+    }
+
+    varlen_batch_free(&input);
+    return status == 0 ? 0 : -1;
+}